@@ -12,6 +12,7 @@
 #include "lilac/Log.hpp"
 #include "lilac/Mod.hpp"
 #include "lilac/Loader.hpp"
+#include "lilac/Signature.hpp"
 #include "lilac/windows.hpp"
 
 // restore dll-interface warnings for other mods
@@ -1,20 +1,158 @@
 #pragma once
 
 #include "macros.hpp"
+#include "SlotMap.hpp"
+#include <utils/Result.hpp>
 #include <inttypes.h>
+#include <string>
+#include <vector>
+
+class HookTransaction;
+class HookChain;
+class HookInstrumentation;
+struct HookCounters;
 
 namespace lilac {
     class Mod;
     class ModBase;
     class Loader;
 
+    /**
+     * How a hook gets into the hooked function
+     */
+    enum class HookMode {
+        /**
+         * Use the owning mod's mode, set with 
+         * "hookMode" in its mod.json
+         */
+        Default,
+        /**
+         * Place a breakpoint on the function 
+         * and redirect it from an exception 
+         * handler. Works on any function, but 
+         * every call pays for the exception.
+         */
+        Trap,
+        /**
+         * Overwrite the start of the function 
+         * with a jump. Much cheaper per call, 
+         * but only works if the instructions 
+         * it overwrites can be relocated; if 
+         * they can't, the hook falls back to 
+         * trap mode.
+         */
+        Inline,
+        /**
+         * Leave the function alone and point 
+         * the import table entries of every 
+         * loaded module that imports it to the 
+         * hook instead. Costs nothing but an 
+         * indirect call, but only catches calls 
+         * that go through an import; calls from 
+         * inside the module that exports the 
+         * function, virtual calls and calls from 
+         * modules loaded later aren't hooked. 
+         * Falls back to trap mode if nothing 
+         * imports the function.
+         */
+        Import,
+        /**
+         * Point a virtual table slot to the hook 
+         * instead of touching the function. Only 
+         * set by `Mod::addVirtualHook`; only 
+         * catches calls through that table.
+         */
+        Virtual,
+    };
+
+    /**
+     * Options for creating a hook
+     */
+    struct HookOptions {
+        /**
+         * When multiple hooks are placed on the 
+         * same address, the detours are called 
+         * in order of descending priority; the 
+         * detour with the highest priority is 
+         * called first and the one with the 
+         * lowest priority calls the original 
+         * function. Hooks with equal priority 
+         * are called in the order they were 
+         * created.
+         */
+        int m_priority = 0;
+        /**
+         * Lazy hooks are recorded, but not 
+         * written into the game's code until 
+         * they are actually needed: when 
+         * `m_trigger` is fired through 
+         * `Loader::fireHookTrigger`, or when 
+         * the owning mod calls `Mod::enableHook` 
+         * on it, which installs it right away. 
+         * Calling `Mod::disableHook` on a lazy 
+         * hook cancels it. 
+         * 
+         * A lazy hook without a trigger is only 
+         * installed by `Mod::enableHook`, or when 
+         * its mod is enabled again after being 
+         * disabled. If the trigger fires while 
+         * the mod is disabled, the hook is 
+         * installed once the mod is enabled.
+         */
+        bool m_lazy = false;
+        /**
+         * Name of the trigger that installs 
+         * this hook, if it is lazy
+         */
+        std::string m_trigger;
+        /**
+         * How the hook is installed. All hooks 
+         * on one address share one installed 
+         * hook, which is inline if any of them 
+         * asks for inline mode.
+         */
+        HookMode m_mode = HookMode::Default;
+    };
+
+    /**
+     * Call statistics for a hook. Only 
+     * collected while hook instrumentation 
+     * is turned on (`hookstats on` in the 
+     * console); times are in TSC ticks.
+     */
+    struct HookStats {
+        /**
+         * Number of calls to the detour
+         */
+        uint64_t m_calls = 0;
+        /**
+         * Cumulative time spent in the detour, 
+         * including everything it called
+         */
+        uint64_t m_totalTicks = 0;
+        uint64_t m_minTicks = UINT64_MAX;
+        uint64_t m_maxTicks = 0;
+        /**
+         * Latency histogram; bucket N counts 
+         * calls that took between 2^N and 
+         * 2^(N+1) ticks
+         */
+        uint64_t m_histogram[64] = {};
+    };
+
     class LILAC_DLL Hook {
     protected:
         Mod*  m_owner;
         void* m_address;
         void* m_detour;
         void* m_handle = nullptr;
+        ::HookCounters* m_stats = nullptr;
+        int   m_priority = 0;
         bool  m_enabled;
+        bool  m_lazy = false;
+        std::string m_trigger;
+        HookMode m_mode = HookMode::Default;
+        SlotHandle m_slot;
 
         // Only allow friend classes to create
         // hooks. Whatever method created the
@@ -30,6 +168,10 @@ namespace lilac {
         friend class Mod;
         friend class Loader;
         friend class ModBase;
+        friend class ::HookTransaction;
+        friend class ::HookChain;
+        friend class ::HookInstrumentation;
+        template <class> friend class SlotMap;
 
     public:
         /**
@@ -46,6 +188,50 @@ namespace lilac {
          */
         bool isEnabled() const { return m_enabled; }
 
+        /**
+         * Get the priority of this hook in the 
+         * chain of hooks on its address.
+         * @returns Priority
+         */
+        int getPriority() const { return m_priority; }
+
+        /**
+         * Get whether the hook is lazy and 
+         * still waiting to be installed.
+         * @returns True if waiting, false if not.
+         */
+        bool isLazy() const { return m_lazy; }
+
+        /**
+         * Get the mode this hook asked for. 
+         * Whether it actually got it depends 
+         * on the other hooks on its address 
+         * and on whether the function can be 
+         * hooked inline.
+         * @returns Mode
+         */
+        HookMode getMode() const { return m_mode; }
+
+        /**
+         * Get a handle to this hook that can 
+         * be checked with `Mod::getHook`, 
+         * which unlike the hook pointer is 
+         * safe to keep around after the hook 
+         * has been removed.
+         * @returns Handle
+         */
+        SlotHandle getHandle() const { return m_slot; }
+
+        /**
+         * Get the call statistics of this hook. 
+         * Empty unless hook instrumentation has 
+         * been turned on. The hook may be getting 
+         * called while this runs, so the fields 
+         * may be a call or two apart.
+         * @returns Snapshot of the statistics
+         */
+        HookStats getStats() const;
+
         /**
          * Get the owner of this hook.
          * @returns Pointer to the owner's Mod handle.
@@ -60,7 +246,15 @@ namespace lilac {
         void* m_address;
         byte_array m_original;
         byte_array m_patch;
+        /**
+         * What the original bytes are expected 
+         * to be, if the patch declared it, and 
+         * which of them have to match
+         */
+        byte_array m_expected;
+        byte_array m_expectedMask;
         bool  m_applied;
+        SlotHandle m_slot;
     
         // Only allow friend classes to create
         // patches. Whatever method created the
@@ -76,6 +270,8 @@ namespace lilac {
         friend class Mod;
         friend class Loader;
         friend class ModBase;
+        friend class PatchSet;
+        template <class> friend class SlotMap;
 
     public:
         /**
@@ -90,13 +286,123 @@ namespace lilac {
          */
         bool isApplied() const { return m_applied; }
 
+        /**
+         * Get a handle to this patch that can 
+         * be checked with `Mod::getPatch`.
+         * @returns Handle
+         */
+        SlotHandle getHandle() const { return m_slot; }
+
+        /**
+         * Get the size of the patch.
+         * @returns Size in bytes
+         */
+        size_t getSize() const { return m_patch.size(); }
+
         bool apply();
         bool restore();
 
+        /**
+         * Check that the patched memory still 
+         * holds what it should: the patch if it's 
+         * applied, and the original bytes (or the 
+         * expected ones, if declared) if not.
+         * @returns True if it does, false if 
+         * something else has written over it
+         */
+        bool verify() const;
+
         /**
          * Get the owner of this patch.
          * @returns Pointer to the owner's Mod handle.
          */
         Mod* getOwner() const { return m_owner; }
     };
+
+    /**
+     * A group of patches that are applied and 
+     * restored together. Patches next to each 
+     * other are merged into one write, and 
+     * every page the set touches is made 
+     * writable once for the whole set instead 
+     * of once per patch, so toggling many 
+     * small patches at once costs about as 
+     * much as toggling one.
+     * 
+     * Either every patch in the set is written 
+     * or none is: if any page can't be made 
+     * writable, nothing is changed. The set 
+     * doesn't own its patches; patches removed 
+     * with `Mod::unpatch` drop out of it.
+     * ```
+     * PatchSet noclip;
+     * for (auto const& [address, bytes] : patches) {
+     *     noclip.add(this->patch(address, bytes, false).value());
+     * }
+     * noclip.apply();
+     * ```
+     * @class PatchSet
+     */
+    class LILAC_DLL PatchSet {
+    protected:
+        struct Run {
+            uintptr_t  m_address;
+            byte_array m_patch;
+            byte_array m_original;
+        };
+
+        std::vector<Patch*> m_patches;
+        /**
+         * Owner & handle of every patch, to 
+         * tell if it has been removed without 
+         * touching the patch itself
+         */
+        std::vector<std::pair<Mod*, SlotHandle>> m_handles;
+        /**
+         * Patches merged into contiguous runs, 
+         * in order of address; rebuilt when 
+         * the set changes
+         */
+        std::vector<Run> m_runs;
+        bool m_dirty = false;
+        bool m_applied = false;
+
+        /**
+         * Drop patches that have been removed 
+         * since they were added
+         */
+        void prune();
+        void build();
+        Result<> write(bool apply);
+
+    public:
+        /**
+         * Add a patch to the set. Doesn't apply 
+         * or restore it, even if the rest of 
+         * the set is applied.
+         * @returns Successful result on success, 
+         * errorful result if the patch overlaps 
+         * one already in the set
+         */
+        Result<> add(Patch* patch);
+        void remove(Patch* patch);
+
+        /**
+         * Write every patch in the set
+         */
+        Result<> apply();
+        /**
+         * Write back the original bytes of every 
+         * patch in the set
+         */
+        Result<> restore();
+
+        bool isApplied() const;
+        std::vector<Patch*> getPatches() const;
+        /**
+         * Get the number of separate writes 
+         * applying the set takes
+         */
+        size_t getRunCount();
+    };
 }
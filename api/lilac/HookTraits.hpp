@@ -0,0 +1,195 @@
+#pragma once
+
+#include "SlotMap.hpp"
+#include <type_traits>
+#include <utility>
+
+namespace lilac {
+    class Mod;
+
+    /**
+     * Signature info for a hookable function, 
+     * by the type of a pointer to it. Member 
+     * functions are hooked with a free 
+     * function detour that takes `this` as 
+     * its first parameter; on x86 Windows 
+     * that's a `__fastcall` function with an 
+     * unused `edx_t` second parameter, as a 
+     * `__thiscall` function can't be declared 
+     * outside a class.
+     * 
+     * `detour_type` is what a detour for the 
+     * function looks like, `class_type` is the 
+     * class of a member function, and `accepts<D>` 
+     * is whether `D` is a valid detour; a 
+     * member function detour may take any 
+     * class derived from the hooked one as 
+     * `this`.
+     */
+    template <class Func>
+    struct HookTraits {
+        static constexpr bool is_hookable = false;
+    };
+
+    namespace hook_traits_detail {
+        template <class Target, class Detour>
+        struct accepts_self : std::false_type {};
+
+        template <class Target, class Self>
+        struct accepts_self<Target*, Self*> : std::is_base_of<
+            std::remove_cv_t<Target>, std::remove_cv_t<Self>
+        > {};
+    }
+
+    #if defined(_MSC_VER) && defined(_M_IX86)
+
+    // calling conventions are part of the function 
+    // type here, so a detour with the wrong one is 
+    // a different type and doesn't match
+
+    #define LILAC_HOOK_TRAITS_FREE(_conv_)                                  \
+        template <class R, class... A>                                      \
+        struct HookTraits<R(_conv_*)(A...)> {                               \
+            static constexpr bool is_hookable = true;                       \
+            using detour_type = R(_conv_*)(A...);                           \
+            template <class D>                                              \
+            static constexpr bool accepts = std::is_same_v<D, detour_type>; \
+            static R call(detour_type func, A... args) {                    \
+                return func(std::forward<A>(args)...);                      \
+            }                                                               \
+        };
+
+    LILAC_HOOK_TRAITS_FREE(__cdecl)
+    LILAC_HOOK_TRAITS_FREE(__stdcall)
+    LILAC_HOOK_TRAITS_FREE(__fastcall)
+
+    #undef LILAC_HOOK_TRAITS_FREE
+
+    namespace hook_traits_detail {
+        template <class D, class R, class C, class... A>
+        struct member_detour_accepts : std::false_type {};
+
+        template <class R, class C, class S, class... A>
+        struct member_detour_accepts<R(__fastcall*)(S*, edx_t, A...), R, C, A...>
+            : accepts_self<C*, S*> {};
+    }
+
+    #define LILAC_HOOK_TRAITS_MEMBER(_const_)                                       \
+        template <class R, class C, class... A>                                     \
+        struct HookTraits<R(__thiscall C::*)(A...) _const_> {                       \
+            static constexpr bool is_hookable = true;                               \
+            using class_type = C;                                                   \
+            using detour_type = R(__fastcall*)(C _const_*, edx_t, A...);            \
+            template <class D>                                                      \
+            static constexpr bool accepts =                                         \
+                hook_traits_detail::member_detour_accepts<D, R, C, A...>::value;    \
+            static R call(detour_type func, C _const_* self, A... args) {           \
+                return func(self, edx_t(), std::forward<A>(args)...);               \
+            }                                                                       \
+        };
+
+    #else
+
+    template <class R, class... A>
+    struct HookTraits<R(*)(A...)> {
+        static constexpr bool is_hookable = true;
+        using detour_type = R(*)(A...);
+        template <class D>
+        static constexpr bool accepts = std::is_same_v<D, detour_type>;
+        static R call(detour_type func, A... args) {
+            return func(std::forward<A>(args)...);
+        }
+    };
+
+    namespace hook_traits_detail {
+        template <class D, class R, class C, class... A>
+        struct member_detour_accepts : std::false_type {};
+
+        template <class R, class C, class S, class... A>
+        struct member_detour_accepts<R(*)(S*, A...), R, C, A...>
+            : accepts_self<C*, S*> {};
+    }
+
+    #define LILAC_HOOK_TRAITS_MEMBER(_const_)                                       \
+        template <class R, class C, class... A>                                     \
+        struct HookTraits<R(C::*)(A...) _const_> {                                  \
+            static constexpr bool is_hookable = true;                               \
+            using class_type = C;                                                   \
+            using detour_type = R(*)(C _const_*, A...);                             \
+            template <class D>                                                      \
+            static constexpr bool accepts =                                         \
+                hook_traits_detail::member_detour_accepts<D, R, C, A...>::value;    \
+            static R call(detour_type func, C _const_* self, A... args) {           \
+                return func(self, std::forward<A>(args)...);                        \
+            }                                                                       \
+        };
+
+    #endif
+
+    LILAC_HOOK_TRAITS_MEMBER()
+    LILAC_HOOK_TRAITS_MEMBER(const)
+
+    #undef LILAC_HOOK_TRAITS_MEMBER
+
+    /**
+     * Address of a hookable function. Free 
+     * functions are hooked where they are; 
+     * for anything else, such as game 
+     * functions declared in headers, 
+     * specialize this to tell lilac where 
+     * the function is:
+     * ```
+     * template <>
+     * struct lilac::HookAddress<&GJGarageLayer::init> {
+     *     static void* get() { return as<void*>(gd_base + 0x1255d0); }
+     * };
+     * ```
+     */
+    template <auto Func, class = void>
+    struct HookAddress {
+        static constexpr bool is_known = false;
+    };
+
+    template <auto Func>
+    struct HookAddress<Func, std::enable_if_t<std::is_pointer_v<decltype(Func)>>> {
+        static constexpr bool is_known = true;
+        static void* get() { return reinterpret_cast<void*>(Func); }
+    };
+
+    /**
+     * Where `original<Func>` calls into; the 
+     * trampoline of the typed hook created on 
+     * `Func` by this binary. There's only room 
+     * for one, so while that hook is alive 
+     * another typed hook on `Func` is refused.
+     */
+    template <auto Func>
+    struct HookOriginal {
+        static inline typename HookTraits<decltype(Func)>::detour_type s_function = nullptr;
+        static inline Mod* s_owner = nullptr;
+        static inline SlotHandle s_hook;
+    };
+
+    /**
+     * Call the next detour in the chain of a 
+     * function hooked with the typed 
+     * `Mod::addHook`, or the original if 
+     * there is none. The arguments are 
+     * checked against the function's 
+     * signature at compile time, and the 
+     * call itself is a single indirect call 
+     * into the hook's trampoline.
+     * ```
+     * bool __fastcall GJGarageLayer_init(GJGarageLayer* self, edx_t) {
+     *     if (!original<&GJGarageLayer::init>(self)) return false;
+     *     // ...
+     * }
+     * ```
+     */
+    template <auto Func, class... Args>
+    decltype(auto) original(Args&&... args) {
+        return HookTraits<decltype(Func)>::call(
+            HookOriginal<Func>::s_function, std::forward<Args>(args)...
+        );
+    }
+}
@@ -7,6 +7,7 @@
 #include <string>
 
 class Lilac;
+class ModIndex;
 
 namespace lilac {
     #pragma warning(disable: 4251)
@@ -19,6 +20,7 @@ namespace lilac {
 
     class Mod;
     class Hook;
+    class Patch;
     class LogStream;
     class LogMessage;
     struct UnresolvedMod;
@@ -59,6 +61,20 @@ namespace lilac {
             std::string id;
             bool resolved;
         };
+
+        struct LoadPlan {
+            /**
+             * Indices of the mods that can be 
+             * loaded, dependencies first
+             */
+            std::vector<size_t> order;
+            /**
+             * Indices of the mods in each 
+             * dependency cycle, in the order 
+             * they depend on each other
+             */
+            std::vector<std::vector<size_t>> cycles;
+        };
         
         /**
          * This function is to avoid ridiculous 
@@ -75,9 +91,35 @@ namespace lilac {
          * use it, so who cares
          */
         template<int Schema>
-        Result<MetaCheckResult> checkBySchema(std::string const& path, void* json);
+        static Result<ModInfo> checkBySchema(std::string const& path, void* json);
 
         Result<MetaCheckResult> checkMetaInformation(std::string const& file);
+        /**
+         * Add a mod whose metadata has been read 
+         * to the unresolved mods. Its dependencies 
+         * are checked by `resolveDependencies`
+         */
+        UnresolvedMod* addUnresolvedMod(ModInfo const& info);
+        /**
+         * Build the dependency graph of a set of 
+         * mods and sort it topologically, so that 
+         * dependencies within the set come before 
+         * the mods depending on them, and mods 
+         * are otherwise kept in the order given. 
+         * Mods in a dependency cycle, or that 
+         * depend on one, are left out of the 
+         * order. O(V + E)
+         */
+        static LoadPlan planLoadOrder(std::vector<ModInfo const*> const& mods);
+        /**
+         * Update the dependency states of every 
+         * mod, and load every unresolved mod 
+         * whose required dependencies are all 
+         * loaded, dependencies first. Dependency 
+         * cycles are reported as errors
+         * @returns Amount of mods loaded
+         */
+        size_t resolveDependencies();
         Result<Mod*> loadResolvedMod(std::string const& id);
         Result<Mod*> loadModFromFile(std::string const& file);
         void createDirectories();
@@ -88,12 +130,38 @@ namespace lilac {
         friend class CustomLoader;
         friend class Lilac;
         friend struct ModInfo;
+        friend class ::ModIndex;
         
     public:
         static Loader* get();
         bool setup();
         size_t updateMods();
 
+        /**
+         * Read & parse the metadata of a mod 
+         * file without loading it. Doesn't 
+         * touch the loader, so it's safe to 
+         * call from any thread
+         * @param path Path to the .lilac file
+         * @returns Mod info, with none of its 
+         * dependencies resolved yet
+         */
+        static Result<ModInfo> readModInfo(std::string const& path);
+        /**
+         * Read the metadata of many mod files 
+         * at once on a pool of worker threads
+         * @param paths Paths to .lilac files
+         * @param threads Amount of threads to 
+         * use, or 0 for one per core
+         * @returns Mod info or the reason it 
+         * couldn't be read for each path, in 
+         * the same order as `paths`
+         */
+        static std::vector<Result<ModInfo>> readModInfos(
+            std::vector<std::string> const& paths,
+            unsigned threads = 0
+        );
+
         LogStream& logStream();
         void log(LogMessage* log);
         void deleteLog(LogMessage* log);
@@ -108,6 +176,56 @@ namespace lilac {
         std::vector<Mod*> getLoadedMods() const;
         std::vector<UnresolvedMod*> getUnresolvedMods() const;
         void unloadMod(Mod* mod);
+
+        /**
+         * Fire a lazy hook trigger, installing 
+         * every lazy hook waiting on it. Hooks 
+         * added with an already fired trigger 
+         * are installed right away. Hooks 
+         * owned by disabled mods are installed 
+         * once their mod is enabled again.
+         * @param trigger Name of the trigger
+         * @returns Amount of hooks installed
+         */
+        size_t fireHookTrigger(std::string const& trigger);
+
+        /**
+         * Get every hook placed on an address, 
+         * by any mod, in the order they are 
+         * called
+         * @param address Hooked address
+         * @returns Vector of hooks
+         */
+        std::vector<Hook*> getHooksAt(uintptr_t address) const;
+
+        /**
+         * Get every hook whose hooked bytes 
+         * overlap a range of memory, such as 
+         * the bytes about to be patched
+         * @param address Start of the range
+         * @param size Size of the range
+         * @returns Vector of hooks, in order 
+         * of address
+         */
+        std::vector<Hook*> getHooksInRange(uintptr_t address, size_t size) const;
+
+        /**
+         * Get every patch, by any mod, that 
+         * overlaps a range of memory
+         * @param address Start of the range
+         * @param size Size of the range
+         * @returns Vector of patches, in order 
+         * of address
+         */
+        std::vector<Patch*> getPatchesInRange(uintptr_t address, size_t size) const;
+
+        /**
+         * Check every patch at once against the 
+         * memory it patches, with `Patch::verify`
+         * @returns Patches whose memory doesn't 
+         * hold what it should, in order of address
+         */
+        std::vector<Patch*> verifyPatches() const;
     };
 
 }
@@ -4,6 +4,10 @@
 #include "../keybinds/KeybindAction.hpp"
 #include "macros.hpp"
 #include "types.hpp"
+#include "Hook.hpp"
+#include "HookTraits.hpp"
+#include "Signature.hpp"
+#include "SlotMap.hpp"
 #include <utils/Result.hpp>
 #include <utils/VersionInfo.hpp>
 #include <string_view>
@@ -12,11 +16,13 @@
 
 class Lilac;
 class InternalMod;
+class HookTransaction;
 
 namespace lilac {                  
     struct PlatformInfo;
 
     class Hook;
+    struct HookOptions;
     class Patch;
     class Loader;
     class LogStream;
@@ -93,6 +99,11 @@ namespace lilac {
          * Free-form list of credits.
          */
         std::string m_credits;
+        /**
+         * Mode of hooks created by the mod 
+         * that don't specify one themselves
+         */
+        HookMode m_hookMode = HookMode::Trap;
         /**
          * Dependencies
          */
@@ -133,17 +144,19 @@ namespace lilac {
          */
         PlatformInfo* m_platformInfo;
         /**
-         * Hooks owned by this mod
+         * Hooks owned by this mod, including 
+         * ones that haven't been installed yet
          */
-        std::vector<Hook*> m_hooks;
+        SlotMap<Hook> m_hooks;
         /**
          * Patches owned by this mod
          */
-        std::vector<Patch*> m_patches;
+        SlotMap<Patch> m_patches;
         /**
-         * Whether the mod is enabled or not
+         * Whether the mod is enabled or not; 
+         * mods start out enabled once loaded
          */
-        bool m_enabled;
+        bool m_enabled = true;
         /**
          * Mod info
          */
@@ -185,6 +198,12 @@ namespace lilac {
             Hook* hook = nullptr
         );
         Result<Hook*> addHookBase(Hook* hook);
+
+        /**
+         * Remove every hook / patch at once
+         */
+        void clearHooks();
+        void clearPatches();
     };
 
     /**
@@ -201,6 +220,37 @@ namespace lilac {
 
         void setupInternal();
 
+        /**
+         * A second typed hook on `Func` would 
+         * take over `original<Func>` from the 
+         * first, sending its calls down the 
+         * wrong chain, or back into itself if 
+         * both are on the same one
+         */
+        template <auto Func>
+        static Result<> checkOriginal() {
+            using original = HookOriginal<Func>;
+            if (original::s_owner && original::s_owner->getHook(original::s_hook)) {
+                return Err<>(
+                    "This function already has a typed hook, "
+                    "and original<Func> can only call through "
+                    "one; remove it first or use an untyped "
+                    "hook with its own trampoline"
+                );
+            }
+            return Ok<>();
+        }
+
+        template <auto Func>
+        void setOriginal(Hook* hook, void* trampoline) {
+            using original = HookOriginal<Func>;
+            original::s_function = reinterpret_cast<
+                typename HookTraits<decltype(Func)>::detour_type
+            >(trampoline);
+            original::s_owner = this;
+            original::s_hook = hook->getHandle();
+        }
+
         friend class InternalMod;
 
     protected:
@@ -249,6 +299,7 @@ namespace lilac {
 
         friend class Loader;
         friend class Lilac;
+        friend class ::HookTransaction;
 
     public:
         std::string getID()         const;
@@ -259,6 +310,7 @@ namespace lilac {
         std::string getCredits()    const;
         std::string getPath()       const;
         VersionInfo getVersion()    const;
+        HookMode    getHookMode()   const { return m_info.m_hookMode; }
         bool        isEnabled()     const;
 
         /**
@@ -289,9 +341,29 @@ namespace lilac {
         std::vector<Hook*> getHooks() const;
 
         /**
-         * Create a hook at an address. Call the original 
-         * function by calling the original function – 
-         * no trampoline needed
+         * Get a hook owned by this Mod by its 
+         * handle
+         * @returns The hook, or nullptr if it 
+         * has been removed
+         */
+        Hook* getHook(SlotHandle const& handle) const;
+
+        /**
+         * Get a patch owned by this Mod by its 
+         * handle
+         * @returns The patch, or nullptr if it 
+         * has been removed
+         */
+        Patch* getPatch(SlotHandle const& handle) const {
+            return m_patches.get(handle);
+        }
+
+        /**
+         * Create a hook at an address whose detour 
+         * replaces the function. To call the original 
+         * from the detour, use an overload that takes 
+         * a trampoline; calling the hooked address 
+         * itself goes through the hook again
          * @param address The absolute address of 
          * the function to hook, i.e. gd_base + 0xXXXX
          * @param detour Pointer to your detour function
@@ -308,13 +380,243 @@ namespace lilac {
          * the function to hook, i.e. gd_base + 0xXXXX
          * @param detour Pointer to your detour function
          * @param trampoline Pointer to a function pointer 
-         * used to call the original
+         * used to call the original. If other mods 
+         * have hooked the same address, this calls 
+         * the next detour in the chain instead
          * @returns Successful result containing the 
          * Hook handle, errorful result with info on 
          * error
          */
         Result<Hook*> addHook(void* address, void* detour, void** trampoline);
 
+        /**
+         * Create a hook at an address with options, 
+         * such as its priority among other hooks 
+         * on the same address
+         * @param address The absolute address of 
+         * the function to hook, i.e. gd_base + 0xXXXX
+         * @param detour Pointer to your detour function
+         * @param options Hook options
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error
+         */
+        Result<Hook*> addHook(
+            void* address,
+            void* detour,
+            HookOptions const& options
+        );
+
+        /**
+         * Create a hook at an address with a detour, 
+         * trampoline and options
+         * @param address The absolute address of 
+         * the function to hook, i.e. gd_base + 0xXXXX
+         * @param detour Pointer to your detour function
+         * @param trampoline Pointer to a function pointer 
+         * used to call the next detour in the chain, 
+         * or the original if there is none
+         * @param options Hook options
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error
+         */
+        Result<Hook*> addHook(
+            void* address,
+            void* detour,
+            void** trampoline,
+            HookOptions const& options
+        );
+
+        /**
+         * Create a hook on a function, with the 
+         * detour's signature (including its 
+         * calling convention) checked against 
+         * the function's at compile time. Call 
+         * the next detour in the chain / the 
+         * original with `lilac::original<Func>`.
+         * ```
+         * this->addHook<&GJGarageLayer::init>(
+         *     gd_base + 0x1255d0, &GJGarageLayer_init
+         * );
+         * ```
+         * @tparam Func Pointer to the hooked 
+         * function
+         * @param address The absolute address of 
+         * the function to hook, i.e. gd_base + 0xXXXX
+         * @param detour Pointer to your detour function
+         * @param options Hook options
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error, such as `Func` already having a 
+         * typed hook from this binary at this or 
+         * another address
+         */
+        template <auto Func, class Detour>
+        Result<Hook*> addHook(
+            void* address,
+            Detour detour,
+            HookOptions const& options = HookOptions()
+        ) {
+            using traits = HookTraits<decltype(Func)>;
+            static_assert(
+                traits::is_hookable,
+                "Func must be a pointer to a function or member function"
+            );
+            static_assert(
+                traits::template accepts<Detour>,
+                "Detour does not match the signature of the hooked function"
+            );
+            auto check = Mod::checkOriginal<Func>();
+            if (!check) {
+                return Err<>(check.error());
+            }
+            void* trampoline = nullptr;
+            auto res = this->addHook(
+                address, reinterpret_cast<void*>(detour), &trampoline, options
+            );
+            if (res) {
+                this->setOriginal<Func>(res.value(), trampoline);
+            }
+            return res;
+        }
+
+        /**
+         * Create a hook on a function whose 
+         * address is known through 
+         * `lilac::HookAddress`, with the 
+         * detour's signature checked at 
+         * compile time.
+         * @tparam Func Pointer to the hooked 
+         * function
+         * @param detour Pointer to your detour function
+         * @param options Hook options
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error
+         */
+        template <auto Func, class Detour>
+        Result<Hook*> addHook(
+            Detour detour,
+            HookOptions const& options = HookOptions()
+        ) {
+            static_assert(
+                HookAddress<Func>::is_known,
+                "The address of this function is not known; specialize "
+                "lilac::HookAddress for it or pass the address to addHook"
+            );
+            return this->addHook<Func>(HookAddress<Func>::get(), detour, options);
+        }
+
+        /**
+         * Get the index of a virtual member 
+         * function in its class's virtual table
+         * @param member Pointer to the bytes of 
+         * the member function pointer
+         * @param size Size of the member function 
+         * pointer
+         * @returns Successful result containing 
+         * the index, errorful result if the 
+         * function isn't virtual or belongs to a 
+         * secondary base class
+         */
+        static Result<size_t> virtualIndexOf(const void* member, size_t size);
+
+        /**
+         * Hook a virtual function by pointing its 
+         * slot in a virtual table to the hook 
+         * instead of patching the function. No 
+         * code is modified, and enabling or 
+         * disabling the hook is a single pointer 
+         * store. Only calls through that table 
+         * are hooked: subclasses that override 
+         * the function or have their own table 
+         * aren't, and neither are non-virtual 
+         * calls to the function.
+         * @param vtable The virtual table
+         * @param index Index of the function in 
+         * the table
+         * @param detour Pointer to your detour function
+         * @param trampoline Pointer to a function pointer 
+         * used to call the next detour in the chain, 
+         * or the original if there is none
+         * @param options Hook options; the mode 
+         * is ignored
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error
+         */
+        Result<Hook*> addVirtualHook(
+            void** vtable,
+            size_t index,
+            void* detour,
+            void** trampoline,
+            HookOptions const& options = HookOptions()
+        );
+
+        /**
+         * Hook a virtual member function in the 
+         * virtual table of an object, with the 
+         * detour's signature checked at compile 
+         * time. Objects of the same class share 
+         * their table, so this hooks the 
+         * function for all of them.
+         * ```
+         * this->addVirtualHook<&CCScheduler::update>(
+         *     CCDirector::sharedDirector()->getScheduler(), 
+         *     &CCScheduler_update
+         * );
+         * ```
+         * @tparam Func Pointer to the hooked 
+         * virtual member function
+         * @param instance Object whose virtual 
+         * table to hook
+         * @param detour Pointer to your detour function
+         * @param options Hook options; the mode 
+         * is ignored
+         * @returns Successful result containing the 
+         * Hook handle, errorful result with info on 
+         * error, such as `Func` already having a 
+         * typed hook from this binary
+         */
+        template <auto Func, class Self, class Detour>
+        Result<Hook*> addVirtualHook(
+            Self* instance,
+            Detour detour,
+            HookOptions const& options = HookOptions()
+        ) {
+            using traits = HookTraits<decltype(Func)>;
+            static_assert(
+                std::is_member_function_pointer_v<decltype(Func)>,
+                "Func must be a pointer to a virtual member function"
+            );
+            static_assert(
+                traits::template accepts<Detour>,
+                "Detour does not match the signature of the hooked function"
+            );
+            auto check = Mod::checkOriginal<Func>();
+            if (!check) {
+                return Err<>(check.error());
+            }
+            auto func = Func;
+            auto index = Mod::virtualIndexOf(&func, sizeof(func));
+            if (!index) {
+                return Err<>(index.error());
+            }
+            // the table pointer is at the start of 
+            // the subobject of the hooked class
+            auto object = static_cast<typename traits::class_type const*>(instance);
+            void* trampoline = nullptr;
+            auto res = this->addVirtualHook(
+                *reinterpret_cast<void** const*>(object), index.value(),
+                reinterpret_cast<void*>(detour), &trampoline, options
+            );
+            if (res) {
+                this->setOriginal<Func>(res.value(), trampoline);
+            }
+            return res;
+        }
+
         /**
          * Enable a hook owned by this Mod
          * @returns Successful result on success, 
@@ -340,10 +642,46 @@ namespace lilac {
          * Write a patch at an address
          * @param address The address to write into
          * @param data The data to write there
+         * @param apply Whether to write it right 
+         * away; leave off to apply it later, 
+         * i.e. as part of a PatchSet
          * @returns Successful result on success, 
          * errorful result with info on error
          */
-        Result<Patch*> patch(void* address, byte_array data);
+        Result<Patch*> patch(void* address, byte_array data, bool apply = true);
+
+        /**
+         * Write a patch at an address, checking 
+         * first that the bytes there are what the 
+         * patch expects them to be. Use this to 
+         * find out right away when another mod 
+         * has already patched or hooked the same 
+         * spot, instead of silently saving its 
+         * bytes as the original.
+         * ```
+         * this->patch(
+         *     as<void*>(gd_base + 0x20a23c), { 0xE9, 0x79, 0x06, 0x00, 0x00 },
+         *     Signature::parse("0F 84 ?? ?? ?? ??").value()
+         * );
+         * ```
+         * @param address The address to write into
+         * @param data The data to write there
+         * @param expected The expected original 
+         * bytes; at least as long as the patch, 
+         * anything past it is only checked once 
+         * when the patch is created
+         * @param apply Whether to write it right 
+         * away
+         * @returns Successful result on success, 
+         * errorful result if the original bytes 
+         * don't match or on other error
+         */
+        Result<Patch*> patch(
+            void* address,
+            byte_array data,
+            Signature const& expected,
+            bool apply = true
+        );
 
         /**
          * Remove a patch owned by this Mod
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "macros.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lilac {
+    #pragma warning(disable: 4251)
+
+    /**
+     * A byte pattern used for finding functions 
+     * in a module without hardcoding their 
+     * offsets, which break whenever the game 
+     * updates.
+     * @class Signature
+     */
+    class LILAC_DLL Signature {
+    protected:
+        byte_array m_bytes;
+        // 0xFF for bytes that must match, 
+        // 0x00 for wildcards
+        byte_array m_mask;
+        ptrdiff_t  m_offset = 0;
+        uint64_t   m_hash = 0;
+
+        friend class SignatureScanner;
+
+    public:
+        /**
+         * Parse a pattern of space-separated hex 
+         * bytes, with `?` or `??` for wildcards, 
+         * i.e. "55 8B EC 6A ?? 68 ?? ?? ?? ??"
+         * @param pattern The pattern
+         * @param offset Offset added to the 
+         * address of the match, for patterns 
+         * that don't start at the function 
+         * they're meant to find
+         * @returns Successful result containing 
+         * the signature, errorful result with 
+         * info on error
+         */
+        static Result<Signature> parse(std::string_view const& pattern, ptrdiff_t offset = 0);
+
+        size_t size() const;
+        ptrdiff_t getOffset() const;
+        /**
+         * Get the concrete bytes of the pattern; 
+         * wildcards are 0
+         */
+        byte_array const& getBytes() const;
+        /**
+         * Get the mask of the pattern; 0xFF for 
+         * bytes that must match, 0 for wildcards
+         */
+        byte_array const& getMask() const;
+        /**
+         * Hash of the pattern & offset, used 
+         * to cache scan results
+         */
+        uint64_t getHash() const;
+
+        /**
+         * Check whether the signature matches 
+         * the memory at `data`
+         */
+        bool matches(const uint8_t* data) const;
+
+        /**
+         * Check whether `data & mask` equals 
+         * `bytes`, 16 bytes at a time
+         * @param mask The mask, or nullptr to 
+         * compare every byte
+         */
+        static bool compare(
+            const uint8_t* data,
+            const uint8_t* bytes,
+            const uint8_t* mask,
+            size_t size
+        );
+    };
+
+    /**
+     * Finds signatures in memory using SSE2 or, 
+     * if the CPU supports it, AVX2. Any number 
+     * of signatures are found with a single 
+     * pass over memory, split across threads.
+     * @class SignatureScanner
+     */
+    class LILAC_DLL SignatureScanner {
+    public:
+        /**
+         * Find the first match of every signature 
+         * in a buffer
+         * @param data Start of the buffer
+         * @param size Size of the buffer
+         * @param signatures Signatures to find
+         * @param threads Amount of threads to use; 
+         * 0 to decide automatically
+         * @returns Vector with the offset of the 
+         * first match of each signature (including 
+         * the signature's own offset), or -1 for 
+         * those that weren't found
+         */
+        static std::vector<ptrdiff_t> scan(
+            const uint8_t* data,
+            size_t size,
+            std::vector<Signature> const& signatures,
+            unsigned threads = 0
+        );
+
+        /**
+         * Find signatures in the executable 
+         * sections of a loaded module. Results 
+         * are cached per module build, so later 
+         * launches of the same game version 
+         * don't scan at all.
+         * @param module Name of the module, i.e. 
+         * "GeometryDash.exe"
+         * @param signatures Signatures to find
+         * @returns Successful result containing 
+         * the absolute address of each signature, 
+         * or 0 for those that weren't found; 
+         * errorful result if the module couldn't 
+         * be found
+         */
+        static Result<std::vector<uintptr_t>> scan(
+            const char* module,
+            std::vector<Signature> const& signatures
+        );
+
+        /**
+         * Find a single signature in the 
+         * executable sections of a loaded module
+         * @returns Successful result containing 
+         * the absolute address of the match, 
+         * errorful result if it wasn't found
+         */
+        static Result<uintptr_t> scan(const char* module, Signature const& signature);
+
+        /**
+         * Get the executable memory ranges of a 
+         * loaded module
+         */
+        static std::vector<std::pair<const uint8_t*, size_t>> getExecutableRanges(
+            const char* module
+        );
+
+        /**
+         * Whether the AVX2 code path is used
+         */
+        static bool hasAVX2();
+    };
+}
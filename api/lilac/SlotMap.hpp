@@ -0,0 +1,227 @@
+#pragma once
+
+#include <inttypes.h>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace lilac {
+    /**
+     * Handle to an object stored in a SlotMap. 
+     * Every time a slot is reused, its 
+     * generation goes up, so a handle to an 
+     * object that has since been removed is 
+     * detected as stale rather than pointing 
+     * at whatever took its place.
+     */
+    struct SlotHandle {
+        uint32_t m_index = UINT32_MAX;
+        uint32_t m_generation = 0;
+
+        bool operator==(SlotHandle const& other) const {
+            return m_index == other.m_index && m_generation == other.m_generation;
+        }
+        bool operator!=(SlotHandle const& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * Container for objects that are handed 
+     * out by pointer. Objects are stored in 
+     * chunks that are never moved, so pointers 
+     * stay valid for as long as the object is 
+     * alive, and a list of the live objects 
+     * is kept packed for iteration. Removed 
+     * slots are reused for new objects.
+     * 
+     * Memory of a removed object is kept 
+     * around, so looking up a stale pointer 
+     * or handle is always safe.
+     * @class SlotMap
+     */
+    template <class T>
+    class SlotMap {
+    protected:
+        static constexpr const uint32_t s_chunkSize = 64;
+        static constexpr const uint32_t s_none = UINT32_MAX;
+
+        struct Slot {
+            alignas(T) unsigned char m_storage[sizeof(T)];
+            uint32_t m_generation = 0;
+            // index in m_live while alive, 
+            // next free slot while not
+            uint32_t m_link = s_none;
+            bool m_alive = false;
+
+            T* get() {
+                return std::launder(reinterpret_cast<T*>(m_storage));
+            }
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> m_chunks;
+        std::vector<T*> m_live;
+        std::vector<uint32_t> m_liveSlots;
+        uint32_t m_freeHead = s_none;
+
+        Slot* slotAt(uint32_t index) const {
+            if (index / s_chunkSize >= m_chunks.size()) return nullptr;
+            return &m_chunks[index / s_chunkSize][index % s_chunkSize];
+        }
+
+        uint32_t indexOf(T const* value) const {
+            auto addr = reinterpret_cast<uintptr_t>(value);
+            for (size_t i = 0; i < m_chunks.size(); i++) {
+                auto start = reinterpret_cast<uintptr_t>(m_chunks[i].get());
+                auto end = start + sizeof(Slot) * s_chunkSize;
+                if (addr >= start && addr < end && !((addr - start) % sizeof(Slot))) {
+                    return static_cast<uint32_t>(i * s_chunkSize + (addr - start) / sizeof(Slot));
+                }
+            }
+            return s_none;
+        }
+
+        void destroy(uint32_t index, Slot* slot) {
+            slot->get()->~T();
+            slot->m_alive = false;
+            slot->m_generation++;
+            slot->m_link = m_freeHead;
+            m_freeHead = index;
+        }
+
+    public:
+        /**
+         * Create a new object in the map
+         * @returns The object's handle & 
+         * the object itself
+         */
+        template <class... Args>
+        std::pair<SlotHandle, T*> emplace(Args&&... args) {
+            if (m_freeHead == s_none) {
+                auto first = static_cast<uint32_t>(m_chunks.size() * s_chunkSize);
+                m_chunks.push_back(std::make_unique<Slot[]>(s_chunkSize));
+                // chain the new slots in order so 
+                // they're handed out front to back
+                for (uint32_t i = s_chunkSize; i-- > 0;) {
+                    m_chunks.back()[i].m_link = m_freeHead;
+                    m_freeHead = first + i;
+                }
+            }
+            auto index = m_freeHead;
+            auto slot = slotAt(index);
+            auto value = new (slot->m_storage) T(std::forward<Args>(args)...);
+            m_freeHead = slot->m_link;
+            slot->m_alive = true;
+            slot->m_link = static_cast<uint32_t>(m_live.size());
+            m_live.push_back(value);
+            m_liveSlots.push_back(index);
+            return { SlotHandle { index, slot->m_generation }, value };
+        }
+
+        /**
+         * @returns The object, or nullptr if 
+         * the handle is stale
+         */
+        T* get(SlotHandle const& handle) const {
+            auto slot = slotAt(handle.m_index);
+            if (!slot || !slot->m_alive || slot->m_generation != handle.m_generation) {
+                return nullptr;
+            }
+            return slot->get();
+        }
+
+        /**
+         * @returns Handle of the object, or an 
+         * invalid handle if the pointer isn't 
+         * a live object in this map
+         */
+        SlotHandle handleOf(T const* value) const {
+            auto index = indexOf(value);
+            auto slot = slotAt(index);
+            if (!slot || !slot->m_alive) {
+                return SlotHandle();
+            }
+            return SlotHandle { index, slot->m_generation };
+        }
+
+        bool contains(SlotHandle const& handle) const {
+            return get(handle) != nullptr;
+        }
+        bool contains(T const* value) const {
+            return handleOf(value) != SlotHandle();
+        }
+        /**
+         * Check an object against the handle it 
+         * was given, i.e. one it stores itself, 
+         * without searching the chunks for it
+         * @returns True if the handle is live 
+         * and refers to exactly this object
+         */
+        bool contains(T const* value, SlotHandle const& handle) const {
+            return value && get(handle) == value;
+        }
+
+        /**
+         * Destroy an object
+         * @returns True if it was destroyed, 
+         * false if the handle was stale
+         */
+        bool erase(SlotHandle const& handle) {
+            if (!contains(handle)) return false;
+            auto slot = slotAt(handle.m_index);
+            // keep the live list packed by moving 
+            // the last entry into the hole
+            auto pos = slot->m_link;
+            m_live[pos] = m_live.back();
+            m_liveSlots[pos] = m_liveSlots.back();
+            slotAt(m_liveSlots[pos])->m_link = pos;
+            m_live.pop_back();
+            m_liveSlots.pop_back();
+            destroy(handle.m_index, slot);
+            return true;
+        }
+        bool erase(T const* value) {
+            return erase(handleOf(value));
+        }
+
+        /**
+         * Destroy every object at once
+         */
+        void clear() {
+            for (auto const& index : m_liveSlots) {
+                destroy(index, slotAt(index));
+            }
+            m_live.clear();
+            m_liveSlots.clear();
+        }
+
+        size_t size() const {
+            return m_live.size();
+        }
+
+        /**
+         * Every live object, packed. Don't 
+         * erase while iterating over this.
+         */
+        std::vector<T*> const& values() const {
+            return m_live;
+        }
+
+        typename std::vector<T*>::const_iterator begin() const {
+            return m_live.begin();
+        }
+        typename std::vector<T*>::const_iterator end() const {
+            return m_live.end();
+        }
+
+        SlotMap() = default;
+        ~SlotMap() {
+            clear();
+        }
+
+        // no copying
+        SlotMap(SlotMap const&) = delete;
+        SlotMap operator=(SlotMap const&) = delete;
+    };
+}
@@ -1,32 +1,14 @@
 #pragma once
 
 #include <lilac.hpp>
+#include "AddressTable.hpp"
 
 USE_LILAC_NAMESPACE();
 
-template<auto Func>
-static uintptr_t addressOf();
+// Offsets of game functions live in addresses.bindings, 
+// which is turned into a table per game build when 
+// building; see AddressTable.
 
-#ifdef LILAC_IS_WINDOWS
-
-template<>
-static uintptr_t addressOf<&EditorUI::keyDown>() {
-    return as<uintptr_t>(gd_base + 0x91a30);
-}
-
-template<>
-static uintptr_t addressOf<&EditorUI::keyUp>() {
-    return as<uintptr_t>(gd_base + 0x92180);
-}
-
-template<>
-static uintptr_t addressOf<&UILayer::keyUp>() {
-    return as<uintptr_t>(gd_base + 0x25fa10);
-}
-
-template<>
-static uintptr_t addressOf<&UILayer::keyDown>() {
-    return as<uintptr_t>(gd_base + 0x25f890);
+inline uintptr_t addressOf(symbol_name const& name) {
+    return AddressTable::addressOf(name);
 }
-
-#endif
@@ -17,8 +17,8 @@ bool __fastcall CCKeyboardDispatcher_dispatchKeyboardMSG(
     }
     return self->dispatchKeyboardMSG(key, down);
 }
-static CreateHookMod<&CCKeyboardDispatcher_dispatchKeyboardMSG>$cckddkmsg(
-    "libcocos2d.dll",
+CREATE_HOOK_MOD(
+    $cckddkmsg, &CCKeyboardDispatcher_dispatchKeyboardMSG, "libcocos2d.dll",
     "?dispatchKeyboardMSG@CCKeyboardDispatcher@cocos2d@@QAE_NW4enumKeyCodes@2@_N@Z"
 );
 
@@ -26,8 +26,8 @@ void __fastcall CCScheduler_update(CCScheduler* self, edx_t, float dt) {
     KeybindManager::get()->handleRepeats(dt);
     return self->update(dt);
 }
-static CreateHookMod<&CCScheduler_update>$ccsu(
-    "libcocos2d.dll",
+CREATE_HOOK_MOD(
+    $ccsu, &CCScheduler_update, "libcocos2d.dll",
     "?update@CCScheduler@cocos2d@@UAEXM@Z"
 );
 
@@ -42,7 +42,7 @@ public:
         return self->CCEGLView::onGLFWMouseCallBack(wnd, btn, pressed, z);
     }
 };
-static CreateHookMod<&CCEGLView_hook::onGLFWMouseCallBack>$ccevogmc(
-    "libcocos2d.dll",
+CREATE_HOOK_MOD(
+    $ccevogmc, &CCEGLView_hook::onGLFWMouseCallBack, "libcocos2d.dll",
     "?onGLFWMouseCallBack@CCEGLView@cocos2d@@IAEXPAUGLFWwindow@@HHH@Z"
 );
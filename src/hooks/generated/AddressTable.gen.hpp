@@ -0,0 +1,19 @@
+// Generated by tools/address_table.py from addresses.bindings; do not edit
+#pragma once
+
+#include "AddressTable.hpp"
+
+// 2.113
+static constexpr address_entry g_addressEntries0[] = {
+    { 0xbe80ef3a39539d05ull, 0x91a30 }, // EditorUI::keyDown
+    { 0xed433ea56e01fbfaull, 0x25fa10 }, // UILayer::keyUp
+    { 0x60d19f913b9bee9bull, 0x25f890 }, // UILayer::keyDown
+    { 0x0ff6fdddb4310890ull, 0x92180 }, // EditorUI::keyUp
+};
+static constexpr uint32_t g_addressSeeds0[] = {
+    6
+};
+
+static constexpr address_table g_addressTables[] = {
+    { "2.113", 0x0000000000000000ull, g_addressEntries0, 4, g_addressSeeds0, 1 },
+};
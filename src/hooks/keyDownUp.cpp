@@ -5,7 +5,7 @@
 //         KB_PLAY_CATEGORY, Keybind(key), PlayLayer::get(), true
 //     );
 // }
-// static CreateHookAddr<&UILayer_keyDown>$UILayer_keyDown(addressOf<&UILayer::keyDown>());
+// CREATE_HOOK(UILayer, keyDown);
 
 // void __fastcall UILayer_keyUp(UILayer* self, edx_t, enumKeyCodes key) {
 //     KeybindManager::get()->handleKeyEvent(
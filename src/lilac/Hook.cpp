@@ -1,11 +1,18 @@
 #include <Hook.hpp>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
 #include <Mod.hpp>
 #include <Loader.hpp>
 #include <utils/casts.hpp>
 #include <utils/vector.hpp>
-#include <core/hook/hook.hpp>
 #include "Internal.hpp"
+#include "InternalMod.hpp"
+#include "HookChain.hpp"
+#include "HookTable.hpp"
+#include "HookTransaction.hpp"
 
 USE_LILAC_NAMESPACE();
 
@@ -17,21 +24,37 @@ struct hook_info {
 static std::vector<hook_info> g_hooks;
 static bool g_readyToHook = false;
 
+// lazy hooks waiting for a trigger 
+// to fire, by trigger name
+static std::unordered_map<std::string, std::vector<Hook*>> g_lazyHooks;
+static std::unordered_set<std::string> g_firedTriggers;
+
 Result<Hook*> ModBase::addHookBase(void* addr, void* detour, Hook* hook) {
     if (!hook) {
-        hook = new Hook();
-        hook->m_address = addr;
+        auto [handle, created] = this->m_hooks.emplace();
+        hook = created;
+        hook->m_slot = handle;
     }
-    if ((hook->m_handle = const_cast<void*>(lilac::core::hook::add(addr, detour)))) {
-        this->m_hooks.push_back(hook);
-        hook->m_enabled = true;
-        return Ok<Hook*>(hook);
-    } else {
-        delete hook;
+    hook->m_address = addr;
+    hook->m_detour = detour;
+    auto chain = HookChain::get(addr);
+    if (!hook->m_handle) {
+        auto link = chain->add(hook);
+        if (!link) {
+            this->m_hooks.erase(hook->m_slot);
+            return Err<>(link.error());
+        }
+    }
+    auto res = chain->enable(hook);
+    if (!res) {
+        chain->remove(hook);
+        this->m_hooks.erase(hook->m_slot);
         return Err<>(
-            "Unable to create hook at " + std::to_string(as<uintptr_t>(addr))
+            "Unable to create hook at " + std::to_string(as<uintptr_t>(addr)) +
+            ": " + res.error()
         );
     }
+    return Ok<Hook*>(hook);
 }
 
 Result<Hook*> ModBase::addHookBase(Hook* hook) {
@@ -42,29 +65,69 @@ Result<Hook*> ModBase::addHookBase(Hook* hook) {
     );
 }
 
+void ModBase::clearHooks() {
+    for (auto const& hook : this->m_hooks) {
+        if (hook->m_lazy && hook->m_trigger.size()) {
+            vector_utils::erase<Hook*>(g_lazyHooks[hook->m_trigger], hook);
+        }
+        if (hook->m_handle) {
+            HookChain::of(hook)->remove(hook);
+        }
+    }
+    g_hooks.erase(std::remove_if(g_hooks.begin(), g_hooks.end(),
+        [this](hook_info const& info) -> bool {
+            return this->m_hooks.contains(info.hook, info.hook->m_slot);
+        }
+    ), g_hooks.end());
+    this->m_hooks.clear();
+}
+
+Hook* Mod::getHook(SlotHandle const& handle) const {
+    return this->m_hooks.get(handle);
+}
+
 Result<> Mod::enableHook(Hook* hook) {
+    if (!hook || !this->m_hooks.contains(hook, hook->m_slot)) {
+        return Err<>("Hook is not owned by this mod or has been removed");
+    }
+    if (hook->m_lazy) {
+        if (hook->m_trigger.size()) {
+            vector_utils::erase<Hook*>(g_lazyHooks[hook->m_trigger], hook);
+        }
+        hook->m_lazy = false;
+        // too early to write any code; 
+        // install along with everything 
+        // else instead
+        if (!g_readyToHook) {
+            g_hooks.push_back({ hook, this });
+            return Ok<>();
+        }
+    }
     if (!hook->isEnabled()) {
-        if (!hook->m_handle) {
-            if ((hook->m_handle = const_cast<void*>(lilac::core::hook::add(hook->m_address, hook->m_detour)))) {
-                hook->m_enabled = true;
-                return Ok<>();
-            }
-            return Err<>("Unable to create hook");
+        if (hook->m_handle) {
+            return HookChain::of(hook)->enable(hook);
         }
-        return Err<>("Hook already has a handle");
+        return Err<>("Hook lacks a handle");
     }
     return Ok<>();
 }
 
 Result<> Mod::disableHook(Hook* hook) {
+    if (!hook || !this->m_hooks.contains(hook, hook->m_slot)) {
+        return Err<>("Hook is not owned by this mod or has been removed");
+    }
+    if (hook->m_lazy) {
+        // never installed, so 
+        // just stop waiting
+        if (hook->m_trigger.size()) {
+            vector_utils::erase<Hook*>(g_lazyHooks[hook->m_trigger], hook);
+        }
+        hook->m_lazy = false;
+        return Ok<>();
+    }
     if (hook->isEnabled()) {
         if (hook->m_handle) {
-            if (lilac::core::hook::remove(hook->m_handle)) {
-                hook->m_enabled = false;
-                hook->m_handle = nullptr;
-                return Ok<>();
-            }
-            return Err<>("Unable to remove hook");
+            return HookChain::of(hook)->disable(hook);
         }
         return Err<>("Hook lacks a handle");
     }
@@ -74,42 +137,260 @@ Result<> Mod::disableHook(Hook* hook) {
 Result<> Mod::removeHook(Hook* hook) {
     auto res = this->disableHook(hook);
     if (res) {
-        vector_utils::erase<Hook*>(this->m_hooks, hook);
-        delete hook;
+        // the chain stays even if this was its 
+        // last hook; see HookChain
+        if (hook->m_handle) {
+            HookChain::of(hook)->remove(hook);
+        }
+        g_hooks.erase(std::remove_if(g_hooks.begin(), g_hooks.end(),
+            [hook](hook_info const& info) -> bool { return info.hook == hook; }
+        ), g_hooks.end());
+        this->m_hooks.erase(hook->m_slot);
     }
     return res;
 }
 
 Result<Hook*> Mod::addHook(void* addr, void* detour) {
+    return this->addHook(addr, detour, nullptr, HookOptions());
+}
+
+Result<Hook*> Mod::addHook(void* addr, void* detour, void** trampoline) {
+    return this->addHook(addr, detour, trampoline, HookOptions());
+}
+
+Result<Hook*> Mod::addHook(void* addr, void* detour, HookOptions const& options) {
+    return this->addHook(addr, detour, nullptr, options);
+}
+
+Result<Hook*> Mod::addHook(
+    void* addr,
+    void* detour,
+    void** trampoline,
+    HookOptions const& options
+) {
+    auto [handle, hook] = this->m_hooks.emplace();
+    hook->m_slot = handle;
+    hook->m_owner = this;
+    hook->m_address = addr;
+    hook->m_detour = detour;
+    hook->m_priority = options.m_priority;
+    hook->m_lazy = options.m_lazy;
+    hook->m_trigger = options.m_trigger;
+    hook->m_mode = options.m_mode;
+
+    // join the chain right away so the 
+    // trampoline is usable immediately
+    auto link = HookChain::get(addr)->add(hook);
+    if (!link) {
+        this->m_hooks.erase(handle);
+        return Err<>(link.error());
+    }
+    if (trampoline) {
+        *trampoline = link.value();
+    }
+
+    // lazy hooks sit disabled in the chain, 
+    // which costs nothing until they're 
+    // actually enabled
+    if (hook->m_lazy) {
+        if (hook->m_trigger.size()) {
+            if (g_firedTriggers.count(hook->m_trigger)) {
+                // a disabled mod gets it once 
+                // it's enabled again
+                if (!this->isEnabled()) {
+                    return Ok<Hook*>(hook);
+                }
+                auto res = this->enableHook(hook);
+                if (!res) {
+                    this->removeHook(hook);
+                    return Err<>(res.error());
+                }
+            } else {
+                g_lazyHooks[hook->m_trigger].push_back(hook);
+            }
+        }
+        return Ok<Hook*>(hook);
+    }
+
     if (g_readyToHook) {
-        return this->addHookBase(addr, detour);
+        return this->addHookBase(addr, detour, hook);
     } else {
-        auto hook = new Hook();
-        hook->m_address = addr;
-        hook->m_detour = detour;
         g_hooks.push_back({ hook, this });
         return Ok<Hook*>(hook);
     }
 }
 
-Result<Hook*> Mod::addHook(void* addr, void* detour, void** trampoline) {
-    *trampoline = addr;
-    return this->addHook(addr, detour);
+Result<size_t> Mod::virtualIndexOf(const void* member, size_t size) {
+    uintptr_t parts[4] = {};
+    memcpy(parts, member, std::min(size, sizeof(parts)));
+    // anything past the function pointer is 
+    // a this-adjustment, which means the 
+    // function is in the table of a base 
+    // class other than the first
+    for (size_t i = 1; i < size / sizeof(uintptr_t) && i < 4; i++) {
+        if (parts[i]) {
+            return Err<>("Function is not in the primary virtual table of its class");
+        }
+    }
+
+    #ifdef _MSC_VER
+
+    // MSVC points to a thunk that loads the 
+    // table from `this` and jumps through 
+    // the function's slot
+    auto code = as<const uint8_t*>(parts[0]);
+    // incremental linking puts a jmp in front
+    for (size_t i = 0; i < 4 && code[0] == 0xE9; i++) {
+        int32_t rel;
+        memcpy(&rel, code + 1, 4);
+        code += 5 + rel;
+    }
+    #ifdef _M_X64
+    // REX.W
+    if (code[0] == 0x48) code++;
+    #endif
+    // mov eax, [ecx]
+    if (code[0] != 0x8B || code[1] != 0x01 || code[2] != 0xFF) {
+        return Err<>("Function is not virtual");
+    }
+    int32_t offset = 0;
+    switch (code[3]) {
+        // jmp [eax]
+        case 0x20: offset = 0; break;
+        // jmp [eax + disp8]
+        case 0x60: offset = static_cast<int8_t>(code[4]); break;
+        // jmp [eax + disp32]
+        case 0xA0: memcpy(&offset, code + 4, 4); break;
+        default: return Err<>("Function is not virtual");
+    }
+    return Ok<size_t>(offset / sizeof(void*));
+
+    #else
+
+    // Itanium ABI: virtual functions are 
+    // stored as 1 + their offset in the table
+    if (!(parts[0] & 1)) {
+        return Err<>("Function is not virtual");
+    }
+    return Ok<size_t>((parts[0] - 1) / sizeof(void*));
+
+    #endif
+}
+
+Result<Hook*> Mod::addVirtualHook(
+    void** vtable,
+    size_t index,
+    void* detour,
+    void** trampoline,
+    HookOptions const& options
+) {
+    if (!vtable) {
+        return Err<>("No virtual table to hook");
+    }
+    auto slot = vtable + index;
+    // the slot may have been redirected 
+    // already by another virtual hook
+    auto chain = HookChain::forVTableSlot(slot);
+    if (!chain) {
+        chain = HookChain::get(*slot);
+        auto res = chain->addVTableSlot(slot);
+        if (!res) {
+            return Err<>(res.error());
+        }
+    }
+    auto virtualOptions = options;
+    virtualOptions.m_mode = HookMode::Virtual;
+    return this->addHook(chain->getAddress(), detour, trampoline, virtualOptions);
 }
 
 bool Lilac::loadHooks() {
+    // lilac's own hooks get queued with 
+    // everything else & installed in the 
+    // same transaction
+    HookTable::load();
+
     g_readyToHook = true;
+
+    auto hooks = std::move(g_hooks);
+    g_hooks.clear();
+
+    // a mod whose hooks can't be installed 
+    // only takes its own hooks down with it: 
+    // its error goes to it and everyone 
+    // else's hooks are tried again without 
+    // it. every round drops one mod, so this 
+    // ends even if every mod fails
     auto thereWereErrors = false;
-    for (auto const& hook : g_hooks) {
-        auto res = hook.mod->addHookBase(hook.hook);
-        if (!res) {
-            hook.mod->throwError(
-                res.error(),
-                Severity::Error
-            );
-            thereWereErrors = true;
+    while (hooks.size()) {
+        HookTransaction transaction;
+        transaction.begin();
+        for (auto const& hook : hooks) {
+            transaction.add(hook.mod, hook.hook);
+        }
+        auto res = transaction.commit();
+        if (res) break;
+
+        thereWereErrors = true;
+        auto mod = transaction.getFailedMod();
+        if (!mod) {
+            InternalMod::get()->throwError(res.error(), Severity::Error);
+            break;
         }
-        g_hooks.clear();
+        mod->throwError(res.error(), Severity::Error);
+        hooks.erase(std::remove_if(hooks.begin(), hooks.end(),
+            [mod](hook_info const& info) -> bool { return info.mod == mod; }
+        ), hooks.end());
     }
     return thereWereErrors;
 }
+
+bool Lilac::hasFiredHookTrigger(std::string const& trigger) const {
+    return g_firedTriggers.count(trigger);
+}
+
+size_t Loader::fireHookTrigger(std::string const& trigger) {
+    g_firedTriggers.insert(trigger);
+
+    auto found = g_lazyHooks.find(trigger);
+    if (found == g_lazyHooks.end()) {
+        return 0;
+    }
+    auto hooks = std::move(found->second);
+    g_lazyHooks.erase(found);
+
+    size_t count = 0;
+    for (auto const& hook : hooks) {
+        auto owner = hook->m_owner;
+        // disabled mods get their hooks 
+        // once they are enabled again; 
+        // the hook stays lazy & keeps its 
+        // trigger, which has now fired
+        if (!owner->isEnabled()) {
+            continue;
+        }
+        auto res = owner->enableHook(hook);
+        if (res) {
+            count++;
+        } else {
+            owner->throwError(res.error(), Severity::Error);
+        }
+    }
+    return count;
+}
+
+std::vector<Hook*> Loader::getHooksAt(uintptr_t address) const {
+    auto chain = HookChain::find(as<void*>(address));
+    if (!chain) {
+        return {};
+    }
+    return chain->getHooks();
+}
+
+std::vector<Hook*> Loader::getHooksInRange(uintptr_t address, size_t size) const {
+    std::vector<Hook*> res;
+    for (auto const& chain : HookChain::findInRange(as<void*>(address), size)) {
+        auto hooks = chain->getHooks();
+        res.insert(res.end(), hooks.begin(), hooks.end());
+    }
+    return res;
+}
@@ -5,6 +5,11 @@
 #include <utils.hpp>
 #include <Internal.hpp>
 #include <InternalMod.hpp>
+#include <ArchiveCache.hpp>
+#include <BinaryCache.hpp>
+#include <ModIndex.hpp>
+#include <algorithm>
+#include <sstream>
 
 USE_LILAC_NAMESPACE();
 
@@ -17,7 +22,9 @@ void Loader::createDirectories() {
     file_utils::createDirectory(const_join_path_c_str<lilac_directory>);
     file_utils::createDirectory(const_join_path_c_str<lilac_directory, lilac_resource_directory>);
     file_utils::createDirectory(const_join_path_c_str<lilac_directory, lilac_mod_directory>);
-    std::filesystem::remove_all(const_join_path_c_str<lilac_directory, lilac_temp_directory>);
+    // extracted binaries are kept between 
+    // launches; see BinaryCache
+    file_utils::createDirectory(const_join_path_c_str<lilac_directory, lilac_temp_directory>);
 }
 
 size_t Loader::updateMods() {
@@ -26,36 +33,79 @@ size_t Loader::updateMods() {
         << "Loading mods..."
         << lilac::endl;
 
-    size_t loaded = 0;
     this->createDirectories();
+
+    std::vector<std::string> paths;
     for (auto const& entry : std::filesystem::directory_iterator(
         std::filesystem::absolute(lilac_directory) / lilac_mod_directory
     )) {
         if (
             std::filesystem::is_regular_file(entry) &&
-            entry.path().extension() == lilac_mod_extension
-        ) {
-            InternalMod::get()->log()
-                << Severity::Debug
-                << "Loading " << entry.path().string()
-                << lilac::endl;
-            if (!vector_utils::contains<Mod*>(
+            entry.path().extension() == lilac_mod_extension &&
+            !vector_utils::contains<Mod*>(
                 this->m_mods,
                 [entry](Mod* p) -> bool {
                     return p->m_info.m_path == entry.path().string();
                 }
-            )) {
-                auto res = this->loadModFromFile(entry.path().string());
-                if (res) {
-                    loaded++;
-                    InternalMod::get()->log()
-                        << "Succesfully loaded " << res.value() << lilac::endl;
-                } else {
-                    InternalMod::get()->throwError(res.error(), Severity::Error);
-                }
-            }
+            )
+        ) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    // directory order is up to the file 
+    // system, and load order shouldn't be
+    std::sort(paths.begin(), paths.end());
+
+    // mods that haven't changed since they 
+    // were last read come from the index; 
+    // the rest are unzipped & parsed on 
+    // worker threads, while actually loading 
+    // the mods is left to this one
+    std::vector<Result<ModInfo>> infos(paths.size(), Err<>("Not read"));
+    std::vector<std::string> changed;
+    std::vector<size_t> changedIndices;
+    for (size_t i = 0; i < paths.size(); i++) {
+        auto cached = ModIndex::get()->lookup(paths[i]);
+        if (cached) {
+            infos[i] = cached.value();
+        } else {
+            changed.push_back(paths[i]);
+            changedIndices.push_back(i);
+        }
+    }
+    auto read = Loader::readModInfos(changed);
+    for (size_t i = 0; i < changed.size(); i++) {
+        ModIndex::get()->store(changed[i], read[i]);
+        infos[changedIndices[i]] = read[i];
+    }
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        InternalMod::get()->log()
+            << Severity::Debug
+            << "Loading " << paths[i]
+            << lilac::endl;
+        if (!infos[i]) {
+            InternalMod::get()->throwError(infos[i].error(), Severity::Error);
+            continue;
         }
+        this->addUnresolvedMod(infos[i].value());
     }
+    // load every mod whose dependencies are 
+    // met, dependencies first
+    auto loaded = this->resolveDependencies();
+
+    // saved after loading, so the index has 
+    // the binaries the mods extracted
+    auto saved = ModIndex::get()->save();
+    if (!saved) {
+        InternalMod::get()->throwError(saved.error(), Severity::Warning);
+    }
+
+    // mods that are still unresolved will 
+    // have to reopen their archive later, 
+    // but file handles shouldn't be held 
+    // on to indefinitely
+    ArchiveCache::get()->clear();
     return loaded;
 }
 
@@ -95,12 +145,7 @@ std::vector<UnresolvedMod*> Loader::getUnresolvedMods() const {
 }
 
 void Loader::updateAllDependencies() {
-    for (auto const& mod : this->m_mods) {
-        mod->m_info.updateDependencyStates();
-    }
-    for (auto const& mod : this->m_unresolvedMods) {
-        mod->m_info.updateDependencyStates();
-    }
+    this->resolveDependencies();
 }
 
 void Loader::unloadMod(Mod* mod) {
@@ -122,6 +167,24 @@ bool Loader::setup() {
     this->createDirectories();
     this->updateMods();
 
+    // binaries of mods that have since been 
+    // updated or removed. mods still waiting 
+    // on a dependency haven't extracted theirs 
+    // this launch, so everything the index 
+    // knows about is kept
+    BinaryCache::get()->collectGarbage(ModIndex::get()->getBinaries());
+
+    // catch mods that patched over each other's 
+    // patches or hooks before it turns into a 
+    // crash somewhere down the line
+    for (auto const& patch : this->verifyPatches()) {
+        std::stringstream ss;
+        ss << "Patch at 0x" << std::hex << patch->getAddress()
+           << " doesn't hold the bytes it should; something "
+              "else has overwritten it";
+        patch->getOwner()->throwError(ss.str(), Severity::Error);
+    }
+
     this->m_isSetup = true;
 
     return true;
@@ -139,7 +202,6 @@ Loader::~Loader() {
         delete log;
     }
     delete this->m_logStream;
-    std::filesystem::remove_all(const_join_path<lilac_directory, lilac_temp_directory>);
 }
 
 LogStream& Loader::logStream() {
@@ -177,3 +239,22 @@ std::vector<LogMessage*> Loader::getLogs(
     return logs;
 }
 
+Result<Loader::MetaCheckResult> Loader::checkMetaInformation(std::string const& path) {
+    auto info = Loader::readModInfo(path);
+    if (!info) {
+        return Err<>(info.error());
+    }
+    auto mod = this->addUnresolvedMod(info.value());
+    mod->m_info.updateDependencyStates();
+    return Ok<MetaCheckResult>({
+        mod->m_info.m_id,
+        !mod->m_info.hasUnresolvedDependencies()
+    });
+}
+
+UnresolvedMod* Loader::addUnresolvedMod(ModInfo const& info) {
+    auto mod = new UnresolvedMod;
+    mod->m_info = info;
+    this->m_unresolvedMods.push_back(mod);
+    return mod;
+}
@@ -12,16 +12,12 @@ Mod::Mod() {}
 
 Mod::~Mod() {
     this->platformCleanup();
-    for (auto const& hook : this->m_hooks) {
-        this->removeHook(hook);
-    }
-    for (auto const& patch : this->m_patches) {
-        patch->restore();
-        vector_utils::erase<Patch*>(this->m_patches, patch);
-        delete patch;
-    }
+    this->clearHooks();
+    this->clearPatches();
     for (auto const& dep : this->m_info.m_dependencies) {
-        vector_utils::erase(dep.m_loaded->m_parentDependencies, this);
+        if (dep.m_loaded) {
+            vector_utils::erase(dep.m_loaded->m_parentDependencies, this);
+        }
     }
 }
 
@@ -32,6 +28,8 @@ void Mod::disable() {}
 void Mod::disableBase() {
     this->m_enabled = false;
     for (auto const& hook : this->m_hooks) {
+        // lazy hooks keep waiting
+        if (hook->isLazy()) continue;
         this->disableHook(hook);
     }
     this->disable();
@@ -43,7 +41,16 @@ void Mod::enableBase() {
     // note: this will enable hooks that were 
     // disabled prior to disabling the mod. 
     // not good!!!
+    // lazy hooks still waiting on their 
+    // trigger keep waiting; the rest, i.e. 
+    // ones without a trigger or whose 
+    // trigger fired while the mod was 
+    // off, are installed now
     for (auto const& hook : this->m_hooks) {
+        if (
+            hook->isLazy() && hook->m_trigger.size() &&
+            !Lilac::get()->hasFiredHookTrigger(hook->m_trigger)
+        ) continue;
         this->enableHook(hook);
     }
     this->enable();
@@ -87,7 +94,7 @@ bool Mod::isEnabled() const {
 }
 
 std::vector<Hook*> Mod::getHooks() const {
-    return this->m_hooks;
+    return this->m_hooks.values();
 }
 
 LogStream& Mod::log() {
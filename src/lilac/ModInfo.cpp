@@ -1,31 +1,29 @@
 #include <Mod.hpp>
 #include <Loader.hpp>
+#include <InternalMod.hpp>
+#include <Log.hpp>
+#include <unordered_map>
 
 USE_LILAC_NAMESPACE();
 
+static ModResolveState dependencyState(Mod* loaded, UnresolvedMod* unresolved) {
+	if (loaded) {
+		return loaded->isEnabled() ? ModResolveState::Loaded : ModResolveState::Disabled;
+	}
+	if (unresolved && !unresolved->m_info.hasUnresolvedDependencies()) {
+		return ModResolveState::Resolved;
+	}
+	return ModResolveState::Unresolved;
+}
+
 void ModInfo::updateDependencyStates() {
+	// only looks at this mod's own dependencies; 
+	// loading the ones that can be loaded is up 
+	// to Loader::resolveDependencies
 	for (auto & dep : this->m_dependencies) {
-		if (!dep.m_unresolved && !dep.m_loaded) {
-			dep.m_unresolved = Loader::get()->getUnresolvedMod(dep.m_id);
-			dep.m_loaded = Loader::get()->getLoadedMod(dep.m_id);
-		}
-		if (dep.m_unresolved) {
-			dep.m_unresolved->m_info.updateDependencyStates();
-			if (dep.m_unresolved->m_info.hasUnresolvedDependencies()) {
-				dep.m_state = ModResolveState::Unresolved;
-			} else {
-				dep.m_state = ModResolveState::Resolved;
-				Loader::get()->loadResolvedMod(dep.m_id);
-			}
-		} else if (dep.m_loaded) {
-			if (dep.m_loaded->isEnabled()) {
-				dep.m_state = ModResolveState::Loaded;
-			} else {
-				dep.m_state = ModResolveState::Disabled;
-			}
-		} else {
-			dep.m_state = ModResolveState::Unresolved;
-		}
+		dep.m_loaded = Loader::get()->getLoadedMod(dep.m_id);
+		dep.m_unresolved = dep.m_loaded ? nullptr : Loader::get()->getUnresolvedMod(dep.m_id);
+		dep.m_state = dependencyState(dep.m_loaded, dep.m_unresolved);
 	}
 }
 
@@ -33,10 +31,83 @@ bool ModInfo::hasUnresolvedDependencies() const {
 	for (auto const& dep : this->m_dependencies) {
 		if (dep.m_required && (
 			dep.m_state == ModResolveState::Unloaded ||
-			dep.m_state == ModResolveState::Unresolved
+			dep.m_state == ModResolveState::Unresolved ||
+			dep.m_state == ModResolveState::Resolved
 		)) {
-			return false;
+			return true;
 		}
 	}
-	return true;
+	return false;
+}
+
+size_t Loader::resolveDependencies() {
+	// index every mod by ID once, rather than 
+	// searching for each dependency
+	std::unordered_map<std::string, Mod*> loaded;
+	std::unordered_map<std::string, UnresolvedMod*> unresolved;
+	for (auto const& mod : this->m_mods) {
+		loaded.insert({ mod->m_info.m_id, mod });
+	}
+	// loading a mod removes it from the 
+	// unresolved mods, so work on a copy
+	auto pending = this->m_unresolvedMods;
+	std::vector<ModInfo const*> infos;
+	for (auto const& mod : pending) {
+		unresolved.insert({ mod->m_info.m_id, mod });
+		infos.push_back(&mod->m_info);
+	}
+
+	auto update = [&](ModInfo& info) {
+		for (auto& dep : info.m_dependencies) {
+			auto isLoaded = loaded.find(dep.m_id);
+			auto isUnresolved = unresolved.find(dep.m_id);
+			dep.m_loaded = isLoaded != loaded.end() ? isLoaded->second : nullptr;
+			dep.m_unresolved = !dep.m_loaded && isUnresolved != unresolved.end() ?
+				isUnresolved->second : nullptr;
+			dep.m_state = dependencyState(dep.m_loaded, dep.m_unresolved);
+		}
+	};
+	for (auto const& mod : this->m_mods) {
+		update(mod->m_info);
+	}
+
+	auto plan = Loader::planLoadOrder(infos);
+	for (auto const& cycle : plan.cycles) {
+		std::string desc;
+		for (auto const& ix : cycle) {
+			desc += pending[ix]->m_info.m_id + " -> ";
+		}
+		desc += pending[cycle.front()]->m_info.m_id;
+		InternalMod::get()->throwError(
+			"Dependency cycle: " + desc + "; none of these mods "
+			"can be loaded until the cycle is broken",
+			Severity::Error
+		);
+	}
+
+	// since dependencies come first, by the time 
+	// a mod is reached every dependency it has 
+	// in the set has either been loaded or 
+	// failed to
+	size_t count = 0;
+	for (auto const& ix : plan.order) {
+		auto mod = pending[ix];
+		update(mod->m_info);
+		if (mod->m_info.hasUnresolvedDependencies()) continue;
+
+		auto res = this->loadResolvedMod(mod->m_info.m_id);
+		if (res) {
+			count++;
+			loaded.insert({ mod->m_info.m_id, res.value() });
+			unresolved.erase(mod->m_info.m_id);
+			InternalMod::get()->log()
+				<< "Succesfully loaded " << res.value() << lilac::endl;
+		} else {
+			InternalMod::get()->throwError(res.error(), Severity::Error);
+		}
+	}
+	for (auto const& mod : this->m_unresolvedMods) {
+		update(mod->m_info);
+	}
+	return count;
 }
@@ -1,49 +1,218 @@
-#include <Hook.hpp>
-#include <vector>
-#include <Mod.hpp>
-#include <Loader.hpp>
-#include <utils/casts.hpp>
-#include <utils/vector.hpp>
-#include <core/hook/hook.hpp>
-#include "Internal.hpp"
-
-USE_LILAC_NAMESPACE();
-
-Result<Patch*> Mod::patch(void* address, byte_array data) {
-    auto p = new Patch;
-    p->m_address = address;
-    p->m_original = byte_array(data.size());
-    if (!lilac::core::hook::read_memory(address, p->m_original.data(), data.size())) {
-        delete p;
-        return Err<>("Unable to read memory at " + std::to_string(p->getAddress()));
-    }
-    p->m_owner = this;
-    p->m_patch = data;
-    if (!p->apply()) {
-        delete p;
-        return Err<>("Unable to enable patch at " + std::to_string(p->getAddress()));
-    }
-    this->m_patches.push_back(p);
-    return Ok<Patch*>(p);
-}
-
-Result<> Mod::unpatch(Patch* patch) {
-    if (patch->restore()) {
-        vector_utils::erase<Patch*>(this->m_patches, patch);
-        delete patch;
-        return Ok<>();
-    }
-    return Err<>("Unable to restore patch!");
-}
-
-bool Patch::apply() {
-    return lilac::core::hook::write_memory(
-        this->m_address, this->m_patch.data(), this->m_patch.size()
-    );
-}
-
-bool Patch::restore() {
-    return lilac::core::hook::write_memory(
-        this->m_address, this->m_original.data(), this->m_original.size()
-    );
-}
+#include <Hook.hpp>
+#include <vector>
+#include <Mod.hpp>
+#include <Loader.hpp>
+#include <utils/casts.hpp>
+#include <utils/vector.hpp>
+#include <core/hook/hook.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include "Internal.hpp"
+#include "RangeIndex.hpp"
+
+USE_LILAC_NAMESPACE();
+
+// every patch by the range it covers
+static RangeIndex<Patch*> g_patches;
+
+// list the mods other than `mod` that have 
+// patched or hooked any of the given bytes
+static std::string describeOverlaps(Mod* mod, uintptr_t address, size_t size) {
+    std::vector<std::string> ids;
+    auto note = [&](Mod* owner) {
+        if (owner == mod) return;
+        auto id = owner->getID();
+        if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
+    };
+    for (auto const& patch : g_patches.find(address, size)) {
+        note(patch->getOwner());
+    }
+    for (auto const& hook : Loader::get()->getHooksInRange(address, size)) {
+        note(hook->getOwner());
+    }
+    std::string res;
+    for (auto const& id : ids) {
+        if (res.size()) res += ", ";
+        res += id;
+    }
+    return res;
+}
+
+static std::string hexString(uintptr_t address) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << address;
+    return ss.str();
+}
+
+Result<Patch*> Mod::patch(void* address, byte_array data, bool apply) {
+    auto [handle, p] = this->m_patches.emplace();
+    p->m_slot = handle;
+    p->m_address = address;
+    p->m_original = byte_array(data.size());
+    if (!lilac::core::hook::read_memory(address, p->m_original.data(), data.size())) {
+        this->m_patches.erase(handle);
+        return Err<>("Unable to read memory at " + std::to_string(as<uintptr_t>(address)));
+    }
+    p->m_owner = this;
+    p->m_patch = data;
+    if (apply && !p->apply()) {
+        this->m_patches.erase(handle);
+        return Err<>("Unable to enable patch at " + std::to_string(as<uintptr_t>(address)));
+    }
+
+    // not an error, since mods may very well 
+    // agree on patching the same bytes, but 
+    // worth knowing when they start acting up
+    auto overlaps = describeOverlaps(this, as<uintptr_t>(address), data.size());
+    if (overlaps.size()) {
+        this->log() << Severity::Warning
+            << "Patch at " << hexString(as<uintptr_t>(address))
+            << " overlaps patches or hooks by " << overlaps
+            << lilac::endl;
+    }
+    g_patches.insert(as<uintptr_t>(address), data.size(), p);
+    return Ok<Patch*>(p);
+}
+
+Result<Patch*> Mod::patch(
+    void* address,
+    byte_array data,
+    Signature const& expected,
+    bool apply
+) {
+    if (expected.size() < data.size()) {
+        return Err<>("Expected bytes don't cover the whole patch");
+    }
+    byte_array current(expected.size());
+    if (!lilac::core::hook::read_memory(address, current.data(), current.size())) {
+        return Err<>("Unable to read memory at " + std::to_string(as<uintptr_t>(address)));
+    }
+    if (!Signature::compare(
+        current.data(), expected.getBytes().data(), expected.getMask().data(), expected.size()
+    )) {
+        auto overlaps = describeOverlaps(this, as<uintptr_t>(address), expected.size());
+        return Err<>(
+            "Bytes at " + hexString(as<uintptr_t>(address)) + 
+            " aren't what the patch expects" + (overlaps.size() ? 
+                "; already patched or hooked by " + overlaps : 
+                "; wrong game version?"
+            )
+        );
+    }
+
+    auto res = this->patch(address, data, false);
+    if (!res) return res;
+    auto p = res.value();
+    p->m_expected.assign(
+        expected.getBytes().begin(), expected.getBytes().begin() + data.size()
+    );
+    p->m_expectedMask.assign(
+        expected.getMask().begin(), expected.getMask().begin() + data.size()
+    );
+    if (apply && !p->apply()) {
+        g_patches.erase(as<uintptr_t>(address), p);
+        this->m_patches.erase(p->m_slot);
+        return Err<>("Unable to enable patch at " + std::to_string(as<uintptr_t>(address)));
+    }
+    return res;
+}
+
+Result<> Mod::unpatch(Patch* patch) {
+    if (!patch || !this->m_patches.contains(patch, patch->m_slot)) {
+        return Err<>("Patch is not owned by this mod or has been removed");
+    }
+    if (patch->restore()) {
+        g_patches.erase(patch->getAddress(), patch);
+        this->m_patches.erase(patch->m_slot);
+        return Ok<>();
+    }
+    return Err<>("Unable to restore patch!");
+}
+
+void ModBase::clearPatches() {
+    for (auto const& patch : this->m_patches) {
+        patch->restore();
+        g_patches.erase(patch->getAddress(), patch);
+    }
+    this->m_patches.clear();
+}
+
+bool Patch::verify() const {
+    auto data = as<const uint8_t*>(this->m_address);
+    auto size = this->m_patch.size();
+    if (this->m_applied) {
+        return Signature::compare(data, this->m_patch.data(), nullptr, size);
+    }
+    if (this->m_expected.size()) {
+        return Signature::compare(
+            data, this->m_expected.data(), this->m_expectedMask.data(), size
+        );
+    }
+    return Signature::compare(data, this->m_original.data(), nullptr, size);
+}
+
+std::vector<Patch*> Loader::getPatchesInRange(uintptr_t address, size_t size) const {
+    return g_patches.find(address, size);
+}
+
+std::vector<Patch*> Loader::verifyPatches() const {
+    // gather what every patch should hold & 
+    // what it actually holds into flat buffers, 
+    // so that they can be compared in one go 
+    // a block at a time; single patches are 
+    // only looked at in blocks that differ
+    byte_array actual;
+    byte_array expected;
+    byte_array mask;
+    std::vector<std::pair<size_t, Patch*>> offsets;
+    offsets.reserve(g_patches.size());
+    g_patches.forEach([&](uintptr_t start, uintptr_t end, Patch* patch) {
+        offsets.push_back({ actual.size(), patch });
+        actual.insert(actual.end(), as<const uint8_t*>(start), as<const uint8_t*>(end));
+        auto size = end - start;
+        if (patch->m_applied) {
+            expected.insert(expected.end(), patch->m_patch.begin(), patch->m_patch.end());
+            mask.insert(mask.end(), size, 0xFF);
+        } else if (patch->m_expected.size()) {
+            expected.insert(
+                expected.end(), patch->m_expected.begin(), patch->m_expected.end()
+            );
+            mask.insert(
+                mask.end(), patch->m_expectedMask.begin(), patch->m_expectedMask.end()
+            );
+        } else {
+            expected.insert(
+                expected.end(), patch->m_original.begin(), patch->m_original.end()
+            );
+            mask.insert(mask.end(), size, 0xFF);
+        }
+    });
+
+    constexpr size_t blockSize = 64;
+    std::vector<Patch*> res;
+    for (size_t pos = 0; pos < actual.size(); pos += blockSize) {
+        auto size = std::min(blockSize, actual.size() - pos);
+        if (Signature::compare(
+            actual.data() + pos, expected.data() + pos, mask.data() + pos, size
+        )) continue;
+
+        // first patch that reaches into the block
+        auto it = std::upper_bound(
+            offsets.begin(), offsets.end(), pos,
+            [](size_t pos, std::pair<size_t, Patch*> const& offset) {
+                return pos < offset.first;
+            }
+        ) - 1;
+        for (; it != offsets.end() && it->first < pos + size; it++) {
+            auto patch = it->second;
+            if (res.size() && res.back() == patch) continue;
+            if (!patch->verify()) {
+                res.push_back(patch);
+            }
+        }
+    }
+    return res;
+}
@@ -0,0 +1,154 @@
+#include <Hook.hpp>
+#include <Mod.hpp>
+#include <utils/casts.hpp>
+#include <core/hook/hook.hpp>
+#include <algorithm>
+#include <cstring>
+#include "Memory.hpp"
+
+USE_LILAC_NAMESPACE();
+
+bool Patch::apply() {
+    if (lilac::core::hook::write_memory(
+        this->m_address, this->m_patch.data(), this->m_patch.size()
+    )) {
+        this->m_applied = true;
+    }
+    return this->m_applied;
+}
+
+bool Patch::restore() {
+    if (lilac::core::hook::write_memory(
+        this->m_address, this->m_original.data(), this->m_original.size()
+    )) {
+        this->m_applied = false;
+    }
+    return !this->m_applied;
+}
+
+void PatchSet::prune() {
+    for (size_t i = 0; i < this->m_patches.size();) {
+        auto [owner, handle] = this->m_handles[i];
+        // patches without an owner can't be 
+        // removed behind the set's back
+        if (owner && owner->getPatch(handle) != this->m_patches[i]) {
+            this->m_patches.erase(this->m_patches.begin() + i);
+            this->m_handles.erase(this->m_handles.begin() + i);
+            this->m_dirty = true;
+        } else {
+            i++;
+        }
+    }
+}
+
+void PatchSet::build() {
+    if (!this->m_dirty) return;
+
+    std::vector<Patch*> sorted = this->m_patches;
+    std::sort(sorted.begin(), sorted.end(), [](Patch* a, Patch* b) {
+        return a->m_address < b->m_address;
+    });
+    this->m_runs.clear();
+    for (auto const& patch : sorted) {
+        auto address = as<uintptr_t>(patch->m_address);
+        // patches can't overlap, so a patch 
+        // either continues the last run or 
+        // starts a new one
+        if (
+            this->m_runs.size() && 
+            this->m_runs.back().m_address + this->m_runs.back().m_patch.size() == address
+        ) {
+            auto& run = this->m_runs.back();
+            run.m_patch.insert(run.m_patch.end(), patch->m_patch.begin(), patch->m_patch.end());
+            run.m_original.insert(
+                run.m_original.end(), patch->m_original.begin(), patch->m_original.end()
+            );
+        } else {
+            this->m_runs.push_back({ address, patch->m_patch, patch->m_original });
+        }
+    }
+    this->m_dirty = false;
+}
+
+Result<> PatchSet::write(bool apply) {
+    this->prune();
+    this->build();
+
+    // make every page writable before 
+    // writing anything, so that the set 
+    // is written either whole or not at all
+    PageUnprotect unprotect;
+    for (auto const& run : this->m_runs) {
+        if (!unprotect.add(as<void*>(run.m_address), run.m_patch.size())) {
+            return Err<>(
+                "Unable to unprotect memory at " + std::to_string(run.m_address)
+            );
+        }
+    }
+    for (auto const& run : this->m_runs) {
+        auto const& bytes = apply ? run.m_patch : run.m_original;
+        memcpy(as<void*>(run.m_address), bytes.data(), bytes.size());
+        ExecutableMemory::flush(as<void*>(run.m_address), bytes.size());
+    }
+    for (auto const& patch : this->m_patches) {
+        patch->m_applied = apply;
+    }
+    this->m_applied = apply;
+    return Ok<>();
+}
+
+Result<> PatchSet::add(Patch* patch) {
+    this->prune();
+    auto start = as<uintptr_t>(patch->m_address);
+    auto end = start + patch->m_patch.size();
+    for (auto const& other : this->m_patches) {
+        if (other == patch) {
+            return Ok<>();
+        }
+        auto otherStart = as<uintptr_t>(other->m_address);
+        auto otherEnd = otherStart + other->m_patch.size();
+        if (start < otherEnd && otherStart < end) {
+            return Err<>(
+                "Patch at " + std::to_string(start) + 
+                " overlaps another patch in the set"
+            );
+        }
+    }
+    this->m_patches.push_back(patch);
+    this->m_handles.push_back({ patch->m_owner, patch->m_slot });
+    this->m_dirty = true;
+    return Ok<>();
+}
+
+void PatchSet::remove(Patch* patch) {
+    for (size_t i = 0; i < this->m_patches.size(); i++) {
+        if (this->m_patches[i] == patch) {
+            this->m_patches.erase(this->m_patches.begin() + i);
+            this->m_handles.erase(this->m_handles.begin() + i);
+            this->m_dirty = true;
+            return;
+        }
+    }
+}
+
+Result<> PatchSet::apply() {
+    return this->write(true);
+}
+
+Result<> PatchSet::restore() {
+    return this->write(false);
+}
+
+bool PatchSet::isApplied() const {
+    return this->m_applied;
+}
+
+std::vector<Patch*> PatchSet::getPatches() const {
+    return this->m_patches;
+}
+
+size_t PatchSet::getRunCount() {
+    this->prune();
+    this->build();
+    return this->m_runs.size();
+}
@@ -0,0 +1,395 @@
+#include <Signature.hpp>
+#include <utils/casts.hpp>
+#include "SymbolResolver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #include <immintrin.h>
+    #define LILAC_TARGET_AVX2
+#else
+    #include <cpuid.h>
+    #include <immintrin.h>
+    #define LILAC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+USE_LILAC_NAMESPACE();
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+Result<Signature> Signature::parse(std::string_view const& pattern, ptrdiff_t offset) {
+    Signature sig;
+    sig.m_offset = offset;
+
+    size_t i = 0;
+    while (i < pattern.size()) {
+        if (pattern[i] == ' ') {
+            i++;
+            continue;
+        }
+        if (pattern[i] == '?') {
+            sig.m_bytes.push_back(0);
+            sig.m_mask.push_back(0x00);
+            i += (i + 1 < pattern.size() && pattern[i + 1] == '?') ? 2 : 1;
+            continue;
+        }
+        auto hi = hexDigit(pattern[i]);
+        auto lo = i + 1 < pattern.size() ? hexDigit(pattern[i + 1]) : -1;
+        if (hi < 0 || lo < 0) {
+            return Err<>(
+                "Invalid byte in signature \"" + std::string(pattern) + 
+                "\" at " + std::to_string(i)
+            );
+        }
+        sig.m_bytes.push_back(static_cast<uint8_t>(hi << 4 | lo));
+        sig.m_mask.push_back(0xFF);
+        i += 2;
+    }
+
+    if (std::find(sig.m_mask.begin(), sig.m_mask.end(), 0xFF) == sig.m_mask.end()) {
+        return Err<>("Signature \"" + std::string(pattern) + "\" has no concrete bytes");
+    }
+
+    // FNV-1a over bytes, mask & offset
+    uint64_t hash = 0xcbf29ce484222325;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3;
+    };
+    for (size_t j = 0; j < sig.m_bytes.size(); j++) {
+        mix(sig.m_bytes[j] & sig.m_mask[j]);
+        mix(sig.m_mask[j]);
+    }
+    for (size_t j = 0; j < sizeof(offset); j++) {
+        mix(static_cast<uint8_t>(offset >> (j * 8)));
+    }
+    sig.m_hash = hash;
+
+    return Ok<Signature>(sig);
+}
+
+size_t Signature::size() const {
+    return this->m_bytes.size();
+}
+
+ptrdiff_t Signature::getOffset() const {
+    return this->m_offset;
+}
+
+uint64_t Signature::getHash() const {
+    return this->m_hash;
+}
+
+byte_array const& Signature::getBytes() const {
+    return this->m_bytes;
+}
+
+byte_array const& Signature::getMask() const {
+    return this->m_mask;
+}
+
+bool Signature::matches(const uint8_t* data) const {
+    return Signature::compare(
+        data, this->m_bytes.data(), this->m_mask.data(), this->m_bytes.size()
+    );
+}
+
+bool Signature::compare(
+    const uint8_t* data,
+    const uint8_t* bytes,
+    const uint8_t* mask,
+    size_t size
+) {
+    // SSE2 is always there on x64 and on 
+    // anything that runs the game on x86, 
+    // so no need to check for it
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        auto a = _mm_loadu_si128(as<const __m128i*>(data + i));
+        if (mask) {
+            a = _mm_and_si128(a, _mm_loadu_si128(as<const __m128i*>(mask + i)));
+        }
+        auto b = _mm_loadu_si128(as<const __m128i*>(bytes + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+            return false;
+        }
+    }
+    for (; i < size; i++) {
+        if ((data[i] & (mask ? mask[i] : 0xFF)) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SignatureScanner::hasAVX2() {
+    static auto g_avx2 = []() -> bool {
+        #ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return false;
+            __cpuid(info, 1);
+            // the OS has to save ymm registers
+            // on context switches too
+            if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return false;
+            if ((_xgetbv(0) & 0x6) != 0x6) return false;
+            __cpuidex(info, 7, 0);
+            return info[1] & (1 << 5);
+        #else
+            return __builtin_cpu_supports("avx2");
+        #endif
+    }();
+    return g_avx2;
+}
+
+// Every signature is pre-filtered by two anchor 
+// bytes: its first and last concrete byte. A 
+// whole vector of candidate positions is checked 
+// against both anchors at once, and only the 
+// positions where both match are compared in 
+// full.
+
+struct anchored_sig {
+    Signature const* m_sig;
+    size_t  m_first;
+    size_t  m_last;
+    uint8_t m_firstByte;
+    uint8_t m_lastByte;
+};
+
+static anchored_sig anchor(Signature const& sig, byte_array const& mask, byte_array const& bytes) {
+    anchored_sig res { &sig };
+    res.m_first = std::find(mask.begin(), mask.end(), 0xFF) - mask.begin();
+    res.m_last = mask.size() - 1 - (std::find(mask.rbegin(), mask.rend(), 0xFF) - mask.rbegin());
+    res.m_firstByte = bytes[res.m_first];
+    res.m_lastByte = bytes[res.m_last];
+    return res;
+}
+
+// Scan positions [begin, end) of `data`, where 
+// `data` is `size` bytes long. `found[i]` holds 
+// the first match of signature i so far, or -1.
+
+static void scanScalar(
+    const uint8_t* data, size_t size, size_t begin, size_t end,
+    anchored_sig const& sig, ptrdiff_t& found
+) {
+    auto len = sig.m_sig->size();
+    if (size < len) return;
+    end = std::min(end, size - len + 1);
+    for (auto pos = begin; pos < end; pos++) {
+        if (
+            data[pos + sig.m_first] == sig.m_firstByte &&
+            data[pos + sig.m_last] == sig.m_lastByte &&
+            sig.m_sig->matches(data + pos)
+        ) {
+            found = pos;
+            return;
+        }
+    }
+}
+
+static size_t scanSSE2(
+    const uint8_t* data, size_t size, size_t begin, size_t end,
+    anchored_sig const& sig, ptrdiff_t& found
+) {
+    auto first = _mm_set1_epi8(static_cast<char>(sig.m_firstByte));
+    auto last = _mm_set1_epi8(static_cast<char>(sig.m_lastByte));
+    auto len = sig.m_sig->size();
+    if (size < len + 16) return begin;
+    // vector loads may not run past the buffer
+    auto vecEnd = std::min(end, size - len + 1 - 16);
+
+    auto pos = begin;
+    for (; pos < vecEnd; pos += 16) {
+        auto a = _mm_loadu_si128(as<const __m128i*>(data + pos + sig.m_first));
+        auto b = _mm_loadu_si128(as<const __m128i*>(data + pos + sig.m_last));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))
+        ));
+        while (mask) {
+            auto bit = 0u;
+            while (!(mask & (1u << bit))) bit++;
+            if (sig.m_sig->matches(data + pos + bit)) {
+                found = pos + bit;
+                return end;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return pos;
+}
+
+LILAC_TARGET_AVX2
+static size_t scanAVX2(
+    const uint8_t* data, size_t size, size_t begin, size_t end,
+    anchored_sig const& sig, ptrdiff_t& found
+) {
+    auto first = _mm256_set1_epi8(static_cast<char>(sig.m_firstByte));
+    auto last = _mm256_set1_epi8(static_cast<char>(sig.m_lastByte));
+    auto len = sig.m_sig->size();
+    if (size < len + 32) return begin;
+    auto vecEnd = std::min(end, size - len + 1 - 32);
+
+    auto pos = begin;
+    for (; pos < vecEnd; pos += 32) {
+        auto a = _mm256_loadu_si256(as<const __m256i*>(data + pos + sig.m_first));
+        auto b = _mm256_loadu_si256(as<const __m256i*>(data + pos + sig.m_last));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))
+        ));
+        while (mask) {
+            auto bit = 0u;
+            while (!(mask & (1u << bit))) bit++;
+            if (sig.m_sig->matches(data + pos + bit)) {
+                found = pos + bit;
+                return end;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return pos;
+}
+
+// Scan a chunk for every signature. The chunk 
+// is walked in blocks small enough to stay in 
+// L1, and each block is checked against every 
+// signature that hasn't been found yet, so 
+// memory is only streamed through once no 
+// matter how many signatures there are.
+static void scanChunk(
+    const uint8_t* data, size_t size, size_t begin, size_t end,
+    std::vector<anchored_sig> const& sigs, std::vector<ptrdiff_t>& found
+) {
+    static constexpr const size_t s_blockSize = 16 * 1024;
+    auto avx2 = SignatureScanner::hasAVX2();
+    size_t remaining = sigs.size();
+
+    for (auto block = begin; block < end && remaining; block += s_blockSize) {
+        auto blockEnd = std::min(end, block + s_blockSize);
+        for (size_t i = 0; i < sigs.size(); i++) {
+            if (found[i] != -1) continue;
+
+            auto pos = block;
+            if (avx2) {
+                pos = scanAVX2(data, size, pos, blockEnd, sigs[i], found[i]);
+            }
+            if (found[i] == -1) {
+                pos = scanSSE2(data, size, pos, blockEnd, sigs[i], found[i]);
+            }
+            if (found[i] == -1) {
+                scanScalar(data, size, pos, blockEnd, sigs[i], found[i]);
+            }
+            if (found[i] != -1) {
+                remaining--;
+            }
+        }
+    }
+}
+
+std::vector<ptrdiff_t> SignatureScanner::scan(
+    const uint8_t* data,
+    size_t size,
+    std::vector<Signature> const& signatures,
+    unsigned threads
+) {
+    std::vector<anchored_sig> sigs;
+    for (auto const& sig : signatures) {
+        sigs.push_back(anchor(sig, sig.m_mask, sig.m_bytes));
+    }
+
+    // don't bother spinning up threads for 
+    // less than a megabyte each
+    static constexpr const size_t s_minChunk = 1024 * 1024;
+    if (!threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::max<size_t>(
+        1, std::min<size_t>(threads, size / s_minChunk)
+    ));
+
+    // each thread scans the start positions in 
+    // its own chunk, but may read past the end 
+    // of it, so matches that straddle chunk 
+    // borders are still found
+    auto chunkSize = (size + threads - 1) / threads;
+    std::vector<std::vector<ptrdiff_t>> found(threads, std::vector<ptrdiff_t>(sigs.size(), -1));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            scanChunk(data, size, t * chunkSize, std::min(size, (t + 1) * chunkSize), sigs, found[t]);
+        });
+    }
+    scanChunk(data, size, 0, std::min(size, chunkSize), sigs, found[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // the first chunk with a match has the 
+    // lowest match
+    std::vector<ptrdiff_t> res(sigs.size(), -1);
+    for (size_t i = 0; i < sigs.size(); i++) {
+        for (unsigned t = 0; t < threads; t++) {
+            if (found[t][i] != -1) {
+                res[i] = found[t][i] + signatures[i].m_offset;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+Result<std::vector<uintptr_t>> SignatureScanner::scan(
+    const char* module,
+    std::vector<Signature> const& signatures
+) {
+    auto base = SymbolResolver::get()->getModuleBase(module);
+    if (!base) {
+        return Err<>(base.error());
+    }
+
+    std::vector<uintptr_t> res(signatures.size(), 0);
+    std::vector<Signature> missing;
+    std::vector<size_t> missingIndices;
+    for (size_t i = 0; i < signatures.size(); i++) {
+        res[i] = SymbolResolver::get()->lookup(module, signatures[i].m_hash);
+        if (!res[i]) {
+            missing.push_back(signatures[i]);
+            missingIndices.push_back(i);
+        }
+    }
+
+    for (auto const& [data, size] : SignatureScanner::getExecutableRanges(module)) {
+        if (missing.empty()) break;
+
+        auto found = SignatureScanner::scan(data, size, missing);
+        for (size_t i = found.size(); i-- > 0;) {
+            if (found[i] == -1) continue;
+
+            auto addr = as<uintptr_t>(data) + found[i];
+            res[missingIndices[i]] = addr;
+            SymbolResolver::get()->remember(module, missing[i].m_hash, addr);
+            missing.erase(missing.begin() + i);
+            missingIndices.erase(missingIndices.begin() + i);
+        }
+    }
+    return Ok<std::vector<uintptr_t>>(res);
+}
+
+Result<uintptr_t> SignatureScanner::scan(const char* module, Signature const& signature) {
+    auto res = SignatureScanner::scan(module, std::vector<Signature> { signature });
+    if (!res) {
+        return Err<>(res.error());
+    }
+    if (!res.value()[0]) {
+        return Err<>("Unable to find signature in module \"" + std::string(module) + "\"");
+    }
+    return Ok<uintptr_t>(res.value()[0]);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Flat hash map keyed by address. Entries 
+ * are stored inline in a single array with 
+ * open addressing & linear probing, so a 
+ * lookup is usually one or two cache lines 
+ * instead of a bucket list walk. Erasing 
+ * shifts the following entries back rather 
+ * than leaving tombstones, so lookups stay 
+ * fast no matter how many entries have come 
+ * and gone. The null address is reserved 
+ * for empty slots and can't be a key.
+ * @class AddressMap
+ */
+template <class T>
+class AddressMap {
+    protected:
+        struct Slot {
+            uintptr_t m_key = 0;
+            T m_value {};
+        };
+
+        std::vector<Slot> m_slots;
+        size_t m_size = 0;
+
+        // fibonacci hashing; addresses tend to 
+        // share their low bits, so those can't 
+        // be used as-is
+        size_t indexOf(uintptr_t key) const {
+            return static_cast<size_t>(
+                (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32
+            ) & (this->m_slots.size() - 1);
+        }
+
+        void rehash(size_t capacity) {
+            auto old = std::move(this->m_slots);
+            this->m_slots = std::vector<Slot>(capacity);
+            this->m_size = 0;
+            for (auto& slot : old) {
+                if (slot.m_key) {
+                    this->insert(slot.m_key, std::move(slot.m_value));
+                }
+            }
+        }
+
+    public:
+        /**
+         * @returns Pointer to the value stored 
+         * for the address, or nullptr if there 
+         * is none
+         */
+        T* find(uintptr_t key) {
+            if (!this->m_size) return nullptr;
+            for (auto ix = this->indexOf(key);; ix = (ix + 1) & (this->m_slots.size() - 1)) {
+                auto& slot = this->m_slots[ix];
+                if (slot.m_key == key) return &slot.m_value;
+                if (!slot.m_key) return nullptr;
+            }
+        }
+        T* find(void* key) {
+            return this->find(reinterpret_cast<uintptr_t>(key));
+        }
+
+        /**
+         * Insert or overwrite the value 
+         * stored for an address
+         * @returns Reference to the stored value
+         */
+        T& insert(uintptr_t key, T value) {
+            // keep the load factor at or below 
+            // one half so probe runs stay short
+            if ((this->m_size + 1) * 2 > this->m_slots.size()) {
+                this->rehash(this->m_slots.size() ? this->m_slots.size() * 2 : 16);
+            }
+            auto ix = this->indexOf(key);
+            while (this->m_slots[ix].m_key && this->m_slots[ix].m_key != key) {
+                ix = (ix + 1) & (this->m_slots.size() - 1);
+            }
+            auto& slot = this->m_slots[ix];
+            if (!slot.m_key) {
+                slot.m_key = key;
+                this->m_size++;
+            }
+            slot.m_value = std::move(value);
+            return slot.m_value;
+        }
+        T& insert(void* key, T value) {
+            return this->insert(reinterpret_cast<uintptr_t>(key), std::move(value));
+        }
+
+        /**
+         * @returns True if the address 
+         * was in the map, false if not
+         */
+        bool erase(uintptr_t key) {
+            if (!this->m_size) return false;
+            auto mask = this->m_slots.size() - 1;
+            auto ix = this->indexOf(key);
+            while (this->m_slots[ix].m_key != key) {
+                if (!this->m_slots[ix].m_key) return false;
+                ix = (ix + 1) & mask;
+            }
+            // pull back every following entry 
+            // that would no longer be reachable 
+            // from its home slot across the hole
+            auto hole = ix;
+            for (auto next = (hole + 1) & mask; this->m_slots[next].m_key; next = (next + 1) & mask) {
+                auto home = this->indexOf(this->m_slots[next].m_key);
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    this->m_slots[hole] = std::move(this->m_slots[next]);
+                    hole = next;
+                }
+            }
+            this->m_slots[hole] = Slot();
+            this->m_size--;
+            return true;
+        }
+        bool erase(void* key) {
+            return this->erase(reinterpret_cast<uintptr_t>(key));
+        }
+
+        size_t size() const {
+            return this->m_size;
+        }
+
+        template <class F>
+        void forEach(F func) const {
+            for (auto const& slot : this->m_slots) {
+                if (slot.m_key) {
+                    func(slot.m_key, slot.m_value);
+                }
+            }
+        }
+};
@@ -0,0 +1,74 @@
+#include "AddressTable.hpp"
+#include "AddressTable.gen.hpp"
+#include <cstring>
+
+address_table const* AddressTable::s_current = nullptr;
+uintptr_t AddressTable::s_base = 0;
+
+uint64_t AddressTable::buildHash(const void* image) {
+    auto base = as<const uint8_t*>(image);
+    if (!base || base[0] != 'M' || base[1] != 'Z') {
+        return 0;
+    }
+    uint32_t ntOffset;
+    memcpy(&ntOffset, base + 0x3C, 4);
+    auto nt = base + ntOffset;
+    if (memcmp(nt, "PE\0\0", 4)) {
+        return 0;
+    }
+    // same offsets for PE32 & PE32+
+    auto optional = nt + 24;
+    uint8_t fields[12];
+    memcpy(fields + 0, nt + 8, 4);          // FileHeader.TimeDateStamp
+    memcpy(fields + 4, optional + 64, 4);   // OptionalHeader.CheckSum
+    memcpy(fields + 8, optional + 56, 4);   // OptionalHeader.SizeOfImage
+    return symbol_name::hash(as<const char*>(fields), sizeof(fields));
+}
+
+address_table const* AddressTable::select(const void* image) {
+    auto build = AddressTable::buildHash(image);
+    address_table const* fallback = nullptr;
+    for (auto const& table : g_addressTables) {
+        if (!table.m_entries) continue;
+        if (build && table.m_build == build) {
+            return &table;
+        }
+        if (!table.m_build) {
+            fallback = &table;
+        }
+    }
+    return fallback;
+}
+
+Result<> AddressTable::load() {
+    if (s_current) {
+        return Ok<>();
+    }
+    auto base = SymbolResolver::get()->getModuleBase(s_gameModule);
+    if (!base) {
+        return Err<>(base.error());
+    }
+    AddressTable::loadFrom(as<void*>(base.value()));
+    if (!s_current) {
+        return Err<>("No function addresses for this game build");
+    }
+    return Ok<>();
+}
+
+void AddressTable::loadFrom(const void* image) {
+    s_current = AddressTable::select(image);
+    s_base = as<uintptr_t>(image);
+}
+
+address_table const* AddressTable::getCurrent() {
+    return s_current;
+}
+
+uintptr_t AddressTable::addressOf(symbol_name const& name) {
+    if (!s_current) {
+        auto res = AddressTable::load();
+        if (!res) return 0;
+    }
+    auto offset = AddressTable::find(*s_current, name);
+    return offset ? s_base + offset : 0;
+}
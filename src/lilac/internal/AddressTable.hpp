@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Mod.hpp>
+#include "SymbolResolver.hpp"
+
+USE_LILAC_NAMESPACE();
+
+struct address_entry {
+    /**
+     * Hash of "Class::method", or 
+     * 0 for an empty slot
+     */
+    uint64_t m_key;
+    uint32_t m_offset;
+};
+
+/**
+ * Offsets of game functions for one game 
+ * build, as a perfect hash table generated 
+ * from src/hooks/addresses.bindings
+ */
+struct address_table {
+    const char* m_name;
+    /**
+     * Header hash of the build, or 0 if 
+     * this is the fallback table
+     */
+    uint64_t m_build;
+    const address_entry* m_entries;
+    size_t m_size;
+    const uint32_t* m_seeds;
+    size_t m_seedCount;
+};
+
+/**
+ * Looks up the address of a game function by 
+ * name in the table for the running game 
+ * build. The table is picked once, by hashing 
+ * the game's PE header, and every lookup is 
+ * one bucket read & one slot read.
+ * 
+ * The hashing here has to match what 
+ * tools/address_table.py generates the 
+ * tables with.
+ * @class AddressTable
+ */
+class AddressTable {
+    protected:
+        static address_table const* s_current;
+        static uintptr_t s_base;
+
+    public:
+        static constexpr const char* s_gameModule = "GeometryDash.exe";
+
+        static constexpr uint64_t mix(uint64_t x) {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+            return x;
+        }
+
+        static constexpr size_t bucketOf(uint64_t key, size_t count) {
+            return static_cast<size_t>((key >> 32) % count);
+        }
+
+        static constexpr size_t slotOf(uint64_t key, uint32_t seed, size_t size) {
+            return static_cast<size_t>(mix(key ^ (seed * 0x9e3779b97f4a7c15ull)) % size);
+        }
+
+        /**
+         * Look a function up in a table
+         * @returns The function's offset, or 0 
+         * if the table doesn't have it
+         */
+        static constexpr uint32_t find(address_table const& table, symbol_name const& name) {
+            if (!table.m_size) return 0;
+            auto seed = table.m_seeds[bucketOf(name.m_hash, table.m_seedCount)];
+            auto const& entry = table.m_entries[slotOf(name.m_hash, seed, table.m_size)];
+            return entry.m_key == name.m_hash ? entry.m_offset : 0;
+        }
+
+        /**
+         * Hash the fields of a PE header that 
+         * identify a build: the linker timestamp, 
+         * checksum and image size
+         * @param image Base of the mapped image
+         * @returns The hash, or 0 if `image` 
+         * isn't a PE image
+         */
+        static uint64_t buildHash(const void* image);
+
+        /**
+         * Pick the generated table for an image
+         * @returns The table for the image's 
+         * build, the fallback table if there's 
+         * none, or nullptr if there's no 
+         * fallback either
+         */
+        static address_table const* select(const void* image);
+
+        /**
+         * Select the table for the running game, 
+         * if that hasn't been done yet
+         */
+        static Result<> load();
+
+        /**
+         * Select the table for an image that 
+         * isn't the game, i.e. a fake module 
+         * image in tests
+         */
+        static void loadFrom(const void* image);
+
+        static address_table const* getCurrent();
+
+        /**
+         * Get the address of a game function
+         * @returns The address, or 0 if the 
+         * function isn't bound for this build
+         */
+        static uintptr_t addressOf(symbol_name const& name);
+};
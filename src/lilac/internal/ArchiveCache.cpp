@@ -0,0 +1,128 @@
+#include "ArchiveCache.hpp"
+#include "BinaryCache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+ArchiveCache* ArchiveCache::get() {
+    static auto g_cache = new ArchiveCache;
+    return g_cache;
+}
+
+std::optional<uint64_t> ArchiveCache::hashDirectory(std::string const& path) {
+    static constexpr const uint32_t s_endSignature = 0x06054b50;
+    // the end record is 22 bytes, followed 
+    // by a comment of up to 64KiB
+    static constexpr const size_t s_endSize = 22;
+    static constexpr const size_t s_maxTail = s_endSize + 0xFFFF;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return std::nullopt;
+    auto size = static_cast<size_t>(file.tellg());
+    if (size < s_endSize) return std::nullopt;
+
+    auto tailSize = std::min(size, s_maxTail);
+    byte_array tail(tailSize);
+    file.seekg(size - tailSize);
+    if (!file.read(reinterpret_cast<char*>(tail.data()), tailSize)) {
+        return std::nullopt;
+    }
+
+    // the last signature is the real one; 
+    // earlier ones may be part of the comment
+    auto end = tailSize - s_endSize + 1;
+    while (end--) {
+        uint32_t signature;
+        memcpy(&signature, tail.data() + end, sizeof(signature));
+        if (signature == s_endSignature) break;
+    }
+    if (end == static_cast<size_t>(-1)) return std::nullopt;
+
+    uint32_t dirSize, dirOffset;
+    memcpy(&dirSize, tail.data() + end + 12, sizeof(dirSize));
+    memcpy(&dirOffset, tail.data() + end + 16, sizeof(dirOffset));
+    auto endOffset = size - tailSize + end;
+    if (static_cast<size_t>(dirOffset) + dirSize > endOffset) {
+        return std::nullopt;
+    }
+
+    // usually the directory is small enough 
+    // to already be in the tail
+    if (dirOffset >= size - tailSize) {
+        auto start = tail.data() + (dirOffset - (size - tailSize));
+        return BinaryCache::hash(start, tail.data() + tailSize - start);
+    }
+    byte_array dir(size - dirOffset);
+    file.seekg(dirOffset);
+    if (!file.read(reinterpret_cast<char*>(dir.data()), dir.size())) {
+        return std::nullopt;
+    }
+    return BinaryCache::hash(dir.data(), dir.size());
+}
+
+Result<std::shared_ptr<ZipFile>> ArchiveCache::open(std::string const& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return Err<>("\"" + path + "\": Unable to read file size - " + ec.message());
+    }
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return Err<>("\"" + path + "\": Unable to read file time - " + ec.message());
+    }
+
+    {
+        std::lock_guard lock(this->m_mutex);
+        auto known = this->m_archives.find(path);
+        if (
+            known != this->m_archives.end() &&
+            known->second.m_size == size &&
+            known->second.m_time == time
+        ) {
+            return Ok(known->second.m_zip);
+        }
+    }
+
+    // opening parses the central directory, 
+    // so don't hold the lock for it
+    auto zip = std::make_shared<ZipFile>(path);
+    if (!zip->isLoaded()) {
+        return Err<>("\"" + path + "\": Unable to unzip");
+    }
+    auto hash = ArchiveCache::hashDirectory(path);
+    if (!hash) {
+        return Err<>("\"" + path + "\": Unable to read zip directory");
+    }
+
+    std::lock_guard lock(this->m_mutex);
+    this->m_archives[path] = { size, time, hash.value(), zip };
+    return Ok(zip);
+}
+
+std::optional<ArchiveCache::archive_stamp> ArchiveCache::stamp(std::string const& path) {
+    std::lock_guard lock(this->m_mutex);
+    auto known = this->m_archives.find(path);
+    if (known == this->m_archives.end()) {
+        return std::nullopt;
+    }
+    return archive_stamp {
+        static_cast<uint64_t>(known->second.m_size),
+        static_cast<int64_t>(known->second.m_time.time_since_epoch().count()),
+        known->second.m_hash,
+    };
+}
+
+void ArchiveCache::release(std::string const& path) {
+    std::lock_guard lock(this->m_mutex);
+    this->m_archives.erase(path);
+}
+
+void ArchiveCache::clear() {
+    std::lock_guard lock(this->m_mutex);
+    this->m_archives.clear();
+}
+
+size_t ArchiveCache::size() {
+    std::lock_guard lock(this->m_mutex);
+    return this->m_archives.size();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <ZipUtils.h>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Open mod archives, kept around between 
+ * reading a mod's mod.json and extracting 
+ * its binary so that each archive is only 
+ * opened and its central directory only 
+ * parsed once per load.
+ * 
+ * Archives are keyed on their path, and 
+ * reopened if the file's size or 
+ * modification time has changed since. 
+ * When an archive is opened its central 
+ * directory, which lists the size and 
+ * CRC-32 of every file in it, is hashed, 
+ * so callers can tell what exactly was 
+ * read from it. 
+ * The loader releases every archive once 
+ * it's done loading mods, so no file 
+ * handles are held on to after startup.
+ * 
+ * Opening is safe from any thread; a 
+ * single archive should only be read from 
+ * one thread at a time.
+ * @class ArchiveCache
+ */
+class ArchiveCache {
+    protected:
+        struct archive_entry {
+            uintmax_t m_size;
+            std::filesystem::file_time_type m_time;
+            uint64_t m_hash;
+            std::shared_ptr<ZipFile> m_zip;
+        };
+
+        std::unordered_map<std::string, archive_entry> m_archives;
+        std::mutex m_mutex;
+
+        ArchiveCache() = default;
+
+    public:
+        struct archive_stamp {
+            uint64_t m_size;
+            int64_t  m_time;
+            uint64_t m_hash;
+        };
+
+        static ArchiveCache* get();
+
+        /**
+         * Hash an archive's central directory 
+         * and end record. Only reads the end of 
+         * the file, but changes along with the 
+         * contents of any file in the archive
+         * @returns The hash, or nothing if the 
+         * file couldn't be read or isn't a zip
+         */
+        static std::optional<uint64_t> hashDirectory(std::string const& path);
+
+        /**
+         * Get an open archive, opening it if it 
+         * isn't open already or has changed on 
+         * disk since
+         * @param path Path to the archive
+         * @returns The archive; stays valid 
+         * even if it's released from the cache
+         */
+        Result<std::shared_ptr<ZipFile>> open(std::string const& path);
+
+        /**
+         * Get the size, modification time & 
+         * directory hash an archive had when it 
+         * was opened
+         * @returns The stamp, or nothing if the 
+         * archive isn't open
+         */
+        std::optional<archive_stamp> stamp(std::string const& path);
+
+        /**
+         * Drop an archive from the cache
+         */
+        void release(std::string const& path);
+
+        /**
+         * Drop every archive from the cache
+         */
+        void clear();
+
+        size_t size();
+};
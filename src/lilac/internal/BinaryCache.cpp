@@ -0,0 +1,122 @@
+#include "BinaryCache.hpp"
+#include <Loader.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+BinaryCache* BinaryCache::get() {
+    static auto g_cache = new BinaryCache;
+    return g_cache;
+}
+
+std::filesystem::path BinaryCache::getDirectory() {
+    return std::filesystem::path(lilac_directory) / lilac_temp_directory;
+}
+
+uint64_t BinaryCache::hash(const uint8_t* data, size_t size) {
+    // FNV-1a, but a word at a time, since 
+    // binaries can be tens of megabytes
+    uint64_t res = 0xcbf29ce484222325 ^ size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        res ^= word;
+        res *= 0x100000001b3;
+        res ^= res >> 29;
+    }
+    for (; i < size; i++) {
+        res ^= data[i];
+        res *= 0x100000001b3;
+    }
+    return res;
+}
+
+bool BinaryCache::matches(std::filesystem::path const& path, const uint8_t* data, size_t size) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    char buffer[0x10000];
+    size_t offset = 0;
+    while (offset < size) {
+        auto chunk = std::min(sizeof(buffer), size - offset);
+        if (!file.read(buffer, chunk) || std::memcmp(buffer, data + offset, chunk)) {
+            return false;
+        }
+        offset += chunk;
+    }
+    // nothing past the expected size either
+    return file.peek() == std::ifstream::traits_type::eof();
+}
+
+std::string BinaryCache::getFileName(uint64_t hash) {
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0')
+         << hash << BinaryCache::s_extension;
+    return name.str();
+}
+
+Result<std::filesystem::path> BinaryCache::extract(const uint8_t* data, size_t size, uint64_t hash) {
+    auto name = BinaryCache::getFileName(hash);
+    auto path = BinaryCache::getDirectory() / name;
+
+    std::lock_guard lock(this->m_mutex);
+    this->m_used.insert(name);
+
+    // a file with the right name & size may 
+    // still have been truncated, tampered with 
+    // or hit a hash collision, so it's only 
+    // reused if it matches byte for byte
+    std::error_code ec;
+    if (
+        std::filesystem::file_size(path, ec) == size && !ec &&
+        BinaryCache::matches(path, data, size)
+    ) {
+        return Ok(path);
+    }
+
+    // write to a temporary file first so a 
+    // crash mid-write doesn't leave behind a 
+    // truncated binary under the right name
+    auto tempPath = path;
+    tempPath += ".part";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return Err<>("Unable to open \"" + tempPath.string() + "\" for writing");
+        }
+        file.write(reinterpret_cast<const char*>(data), size);
+        if (!file) {
+            return Err<>("Unable to write \"" + tempPath.string() + "\"");
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return Err<>("Unable to write \"" + path.string() + "\": " + ec.message());
+    }
+    return Ok(path);
+}
+
+size_t BinaryCache::collectGarbage(std::unordered_set<uint64_t> const& referenced) {
+    std::lock_guard lock(this->m_mutex);
+    auto keep = this->m_used;
+    for (auto const& hash : referenced) {
+        keep.insert(BinaryCache::getFileName(hash));
+    }
+    std::error_code ec;
+    size_t removed = 0;
+    for (auto const& entry : std::filesystem::directory_iterator(
+        BinaryCache::getDirectory(), ec
+    )) {
+        auto name = entry.path().filename().string();
+        if (keep.count(name)) continue;
+        if (std::filesystem::remove(entry.path(), ec)) {
+            removed++;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Mod binaries extracted from their archives, 
+ * stored in lilac/temp under the hash of 
+ * their contents. A mod whose binary hasn't 
+ * changed since the last launch loads the 
+ * file extracted back then, once it's been 
+ * checked to still match, instead of 
+ * writing it out again, which keeps it in 
+ * the OS's page cache & doesn't make 
+ * antivirus scan it all over.
+ * 
+ * Files that weren't used by any mod during 
+ * a launch, and don't belong to a mod that 
+ * is still installed but hasn't been loaded 
+ * yet, are removed by `collectGarbage`.
+ * @class BinaryCache
+ */
+class BinaryCache {
+    protected:
+        /**
+         * File names used during this launch
+         */
+        std::unordered_set<std::string> m_used;
+        std::mutex m_mutex;
+
+        BinaryCache() = default;
+
+    public:
+        static constexpr const char* s_extension = 
+            LILAC_WINDOWS(".dll")
+            LILAC_MACOS(".dylib")
+            LILAC_ANDROID(".so");
+
+        static BinaryCache* get();
+        static std::filesystem::path getDirectory();
+
+        /**
+         * 64-bit hash of a binary; not 
+         * cryptographic, only meant to tell 
+         * builds of a mod apart
+         */
+        static uint64_t hash(const uint8_t* data, size_t size);
+        /**
+         * Name of the file a binary with the 
+         * given hash is extracted to
+         */
+        static std::string getFileName(uint64_t hash);
+
+        /**
+         * Check that an extracted file holds 
+         * exactly the given contents
+         */
+        static bool matches(std::filesystem::path const& path, const uint8_t* data, size_t size);
+
+        /**
+         * Get the path to an extracted binary, 
+         * writing it out first if it hasn't 
+         * been extracted before
+         * @param data Contents of the binary
+         * @param size Size of the binary
+         * @param hash The binary's `hash`, which 
+         * callers keep to refer to the file by
+         * @returns Path to the extracted file
+         */
+        Result<std::filesystem::path> extract(const uint8_t* data, size_t size, uint64_t hash);
+
+        /**
+         * Remove every extracted binary not used 
+         * during this launch nor referenced by 
+         * the caller. Files that can't be 
+         * removed, i.e. because another instance 
+         * of the game has them loaded, are left 
+         * for the next launch.
+         * @param referenced Hashes of binaries to 
+         * keep even though they weren't used, 
+         * i.e. ones of mods waiting on a 
+         * dependency
+         * @returns Amount of files removed
+         */
+        size_t collectGarbage(std::unordered_set<uint64_t> const& referenced);
+};
@@ -0,0 +1,313 @@
+#include "Disassembler.hpp"
+
+// length of a ModRM byte and everything that 
+// follows it (SIB & displacement), or 0 if 
+// it uses 16-bit addressing
+static size_t modrmLength(
+    const uint8_t* modrm,
+    bool addr16,
+    bool x64,
+    size_t& ripOffset
+) {
+    if (addr16) return 0;
+
+    auto mod = *modrm >> 6;
+    auto rm = *modrm & 7;
+    size_t len = 1;
+
+    if (mod == 3) return len;
+
+    if (rm == 4) {
+        auto base = modrm[1] & 7;
+        len++;
+        if (mod == 0 && base == 5) {
+            return len + 4;
+        }
+    } else if (mod == 0 && rm == 5) {
+        // disp32; rip-relative in 64-bit mode
+        if (x64) {
+            ripOffset = len;
+        }
+        return len + 4;
+    }
+    if (mod == 1) len += 1;
+    if (mod == 2) len += 4;
+    return len;
+}
+
+bool Disassembler::decode(const uint8_t* code, instruction_info& info, bool x64) {
+    info = instruction_info();
+    auto p = code;
+
+    bool opsize16 = false;
+    bool addr16 = false;
+    bool rexW = false;
+
+    // legacy prefixes
+    for (;; p++) {
+        if (p - code > 14) return false;
+        switch (*p) {
+            case 0x66: opsize16 = true; continue;
+            case 0x67: addr16 = !x64; continue;
+            case 0xF0: case 0xF2: case 0xF3:
+            case 0x26: case 0x2E: case 0x36:
+            case 0x3E: case 0x64: case 0x65:
+                continue;
+        }
+        break;
+    }
+    if (x64 && (*p & 0xF0) == 0x40) {
+        rexW = *p & 8;
+        p++;
+    }
+
+    auto op = *p++;
+    info.m_opcode = op;
+
+    size_t imm = 0;
+    bool modrm = false;
+    auto immz = static_cast<size_t>(opsize16 ? 2 : 4);
+
+    // VEX; in 32-bit mode C4 & C5 are only VEX 
+    // if what would be their ModRM is mod 11
+    if ((op == 0xC4 || op == 0xC5) && (x64 || (*p >> 6) == 3)) {
+        uint8_t map = 1;
+        if (op == 0xC4) {
+            map = *p & 0x1F;
+            p += 2;
+        } else {
+            p += 1;
+        }
+        op = *p++;
+        info.m_opcode = op;
+        info.m_twoByte = true;
+        if (map == 3) {
+            imm = 1;
+        } else if (map == 1) {
+            switch (op) {
+                case 0x70: case 0x71: case 0x72: case 0x73:
+                case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+                    imm = 1;
+            }
+        } else if (map != 2) {
+            return false;
+        }
+        // vzeroupper / vzeroall
+        if (map == 1 && op == 0x77) {
+            info.m_length = p - code;
+            return true;
+        }
+        size_t rip = 0;
+        auto len = modrmLength(p, addr16, x64, rip);
+        if (!len) return false;
+        if (rip) info.m_ripOffset = (p - code) + rip;
+        info.m_length = (p - code) + len + imm;
+        return true;
+    }
+
+    if (op == 0x0F) {
+        op = *p++;
+        info.m_opcode = op;
+        info.m_twoByte = true;
+
+        if (op >= 0x80 && op <= 0x8F) {
+            // jcc rel32
+            if (opsize16 && !x64) return false;
+            info.m_relOffset = p - code;
+            info.m_relSize = 4;
+            info.m_length = (p - code) + 4;
+            return true;
+        }
+        switch (op) {
+            case 0x38:
+                p++;
+                modrm = true;
+                break;
+            case 0x3A:
+                p++;
+                modrm = true;
+                imm = 1;
+                break;
+            case 0x05: case 0x06: case 0x07: case 0x08: case 0x09:
+            case 0x0B: case 0x0E: case 0x30: case 0x31: case 0x32:
+            case 0x33: case 0x34: case 0x35: case 0x37: case 0x77:
+            case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9:
+            case 0xAA:
+                break;
+            case 0x70: case 0x71: case 0x72: case 0x73:
+            case 0xA4: case 0xAC: case 0xBA: case 0xC2:
+            case 0xC4: case 0xC5: case 0xC6:
+                modrm = true;
+                imm = 1;
+                break;
+            default:
+                if (op >= 0xC8 && op <= 0xCF) break;
+                if (op == 0x0F || op == 0x36 || op == 0x39 || (op >= 0x3B && op <= 0x3F)) {
+                    return false;
+                }
+                modrm = true;
+        }
+    } else if (op < 0x40) {
+        switch (op & 7) {
+            case 0: case 1: case 2: case 3:
+                modrm = true;
+                break;
+            case 4:
+                imm = 1;
+                break;
+            case 5:
+                imm = immz;
+                break;
+            default:
+                // push/pop segment & BCD adjust; 
+                // gone in 64-bit mode
+                if (x64) return false;
+        }
+    } else if (op < 0x60) {
+        // inc/dec/push/pop reg
+    } else if (op >= 0x70 && op <= 0x7F) {
+        info.m_relOffset = p - code;
+        info.m_relSize = 1;
+        info.m_length = (p - code) + 1;
+        return true;
+    } else {
+        switch (op) {
+            case 0x60: case 0x61:
+                if (x64) return false;
+                break;
+            case 0x62:
+                // EVEX in 64-bit mode
+                if (x64) return false;
+                modrm = true;
+                break;
+            case 0x63:
+                modrm = true;
+                break;
+            case 0x68:
+                imm = immz;
+                break;
+            case 0x69:
+                modrm = true;
+                imm = immz;
+                break;
+            case 0x6A:
+                imm = 1;
+                break;
+            case 0x6B:
+                modrm = true;
+                imm = 1;
+                break;
+            case 0x6C: case 0x6D: case 0x6E: case 0x6F:
+                break;
+            case 0x80: case 0x82: case 0x83:
+            case 0xC0: case 0xC1: case 0xC6:
+                if (op == 0x82 && x64) return false;
+                modrm = true;
+                imm = 1;
+                break;
+            case 0x81: case 0xC7:
+                modrm = true;
+                imm = immz;
+                break;
+            case 0x9A: case 0xEA:
+                return false;
+            case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+                imm = x64 ? 8 : (addr16 ? 2 : 4);
+                break;
+            case 0xA8:
+                imm = 1;
+                break;
+            case 0xA9:
+                imm = immz;
+                break;
+            case 0xC2:
+                imm = 2;
+                info.m_endsFlow = true;
+                break;
+            case 0xC3: case 0xCB: case 0xCC:
+                info.m_endsFlow = true;
+                break;
+            case 0xCA:
+                imm = 2;
+                info.m_endsFlow = true;
+                break;
+            case 0xC4: case 0xC5:
+                // LES / LDS
+                modrm = true;
+                break;
+            case 0xC8:
+                imm = 3;
+                break;
+            case 0xCD: case 0xD4: case 0xD5:
+                imm = 1;
+                break;
+            case 0xE0: case 0xE1: case 0xE2: case 0xE3:
+            case 0xEB:
+                info.m_relOffset = p - code;
+                info.m_relSize = 1;
+                info.m_length = (p - code) + 1;
+                info.m_endsFlow = op == 0xEB;
+                return true;
+            case 0xE4: case 0xE5: case 0xE6: case 0xE7:
+                imm = 1;
+                break;
+            case 0xE8: case 0xE9:
+                if (opsize16 && !x64) return false;
+                info.m_relOffset = p - code;
+                info.m_relSize = 4;
+                info.m_length = (p - code) + 4;
+                info.m_endsFlow = op == 0xE9;
+                return true;
+            case 0xF6: case 0xF7:
+                modrm = true;
+                // only test has an immediate
+                if (((*p >> 3) & 7) < 2) {
+                    imm = op == 0xF6 ? 1 : immz;
+                }
+                break;
+            case 0xFF:
+                modrm = true;
+                // indirect jmp
+                if (((*p >> 3) & 7) == 4 || ((*p >> 3) & 7) == 5) {
+                    info.m_endsFlow = true;
+                }
+                break;
+            default:
+                if (op >= 0x84 && op <= 0x8F) {
+                    modrm = true;
+                } else if (op >= 0xB0 && op <= 0xB7) {
+                    imm = 1;
+                } else if (op >= 0xB8 && op <= 0xBF) {
+                    imm = rexW ? 8 : immz;
+                } else if (op >= 0xD0 && op <= 0xD3) {
+                    modrm = true;
+                } else if (op >= 0xD8 && op <= 0xDF) {
+                    modrm = true;
+                } else if (op == 0xFE) {
+                    modrm = true;
+                } else if (
+                    (op >= 0x90 && op <= 0x9F) ||
+                    (op >= 0xA4 && op <= 0xAF) ||
+                    op == 0xC9 || op == 0xCE || op == 0xCF ||
+                    op == 0xD6 || op == 0xD7 ||
+                    (op >= 0xEC && op <= 0xEF) ||
+                    (op >= 0xF1 && op <= 0xF5) ||
+                    (op >= 0xF8 && op <= 0xFD)
+                ) {
+                    // no operands
+                } else {
+                    return false;
+                }
+        }
+    }
+
+    if (modrm) {
+        size_t rip = 0;
+        auto len = modrmLength(p, addr16, x64, rip);
+        if (!len) return false;
+        if (rip) info.m_ripOffset = (p - code) + rip;
+        p += len;
+    }
+    info.m_length = (p - code) + imm;
+    return true;
+}
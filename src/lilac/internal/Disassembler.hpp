@@ -0,0 +1,64 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/**
+ * Info about a single decoded instruction
+ */
+struct instruction_info {
+    size_t  m_length = 0;
+    /**
+     * Offset & size of a relative branch 
+     * operand (jmp / call / jcc / loop), or 
+     * 0 if the instruction has none
+     */
+    size_t  m_relOffset = 0;
+    size_t  m_relSize = 0;
+    /**
+     * Offset of a rip-relative displacement, 
+     * or 0 if the instruction has none. 
+     * Always 32 bits.
+     */
+    size_t  m_ripOffset = 0;
+    /**
+     * Primary opcode; `m_twoByte` if it 
+     * comes after a 0F escape
+     */
+    uint8_t m_opcode = 0;
+    bool    m_twoByte = false;
+    /**
+     * Control never continues to the next 
+     * instruction (jmp / ret / int3)
+     */
+    bool    m_endsFlow = false;
+};
+
+/**
+ * Length disassembler for x86 & x86-64. Only 
+ * figures out how long instructions are and 
+ * where their relative operands are, which 
+ * is all that's needed to move instructions 
+ * somewhere else. Covers the general purpose, 
+ * x87, SSE & VEX encoded instructions found 
+ * in function prologues; anything it doesn't 
+ * know is reported as undecodable rather 
+ * than guessed at.
+ * @class Disassembler
+ */
+class Disassembler {
+    public:
+        static constexpr const bool s_native64 = sizeof(void*) == 8;
+
+        /**
+         * Decode the instruction at `code`
+         * @param x64 Decode as 64-bit code
+         * @returns True if the instruction was 
+         * decoded, false if it isn't supported
+         */
+        static bool decode(
+            const uint8_t* code,
+            instruction_info& info,
+            bool x64 = s_native64
+        );
+};
@@ -0,0 +1,521 @@
+#include "HookChain.hpp"
+#include "HookInstrumentation.hpp"
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <core/hook/hook.hpp>
+
+AddressMap<HookChain*> HookChain::s_chains;
+std::vector<HookChain*> HookChain::s_ordered;
+AddressMap<HookChain*> HookChain::s_vtableSlots;
+
+static bool compareAddress(HookChain* chain, uintptr_t address) {
+    return as<uintptr_t>(chain->getAddress()) < address;
+}
+
+// Stub: jump through the pointer stored right 
+// after the jump, which is aligned so that it 
+// can be swapped out with a single store. No 
+// register is touched, so the detour sees the 
+// exact same state as the hooked function 
+// would, whatever its calling convention.
+// 
+//     jmp [target]
+//     int3; int3
+// target:
+//     dd/dq continuation
+static constexpr const size_t s_targetOffset = 8;
+static constexpr const size_t s_stubSize = s_targetOffset + sizeof(void*);
+
+using stub_target = std::atomic<void*>;
+
+static_assert(
+    sizeof(stub_target) == sizeof(void*) && stub_target::is_always_lock_free,
+    "Stub targets are read by generated code as plain pointers"
+);
+
+static stub_target* targetOf(void* stub) {
+    return as<stub_target*>(as<uint8_t*>(stub) + s_targetOffset);
+}
+
+static void writeStub(uint8_t* stub, void* target) {
+    stub[0] = 0xFF;
+    stub[1] = 0x25;
+    #if defined(_M_IX86) || defined(__i386__)
+        // jmp dword ptr [abs32]
+        auto disp = static_cast<uint32_t>(as<uintptr_t>(stub + s_targetOffset));
+    #elif defined(_M_X64) || defined(__x86_64__)
+        // jmp qword ptr [rip + disp32]
+        auto disp = static_cast<uint32_t>(s_targetOffset - 6);
+    #else
+        #error "HookChain stubs are not implemented for this architecture"
+    #endif
+    memcpy(stub + 2, &disp, 4);
+    stub[6] = 0xCC;
+    stub[7] = 0xCC;
+    new (stub + s_targetOffset) stub_target(target);
+}
+
+// the stub's code never changes, so there's 
+// no need to flush anything
+static void setTarget(void* stub, void* target) {
+    targetOf(stub)->store(target, std::memory_order_release);
+}
+
+HookChain::HookChain(void* address) : m_address(address) {}
+
+HookChain* HookChain::get(void* address) {
+    auto chain = HookChain::find(address);
+    if (!chain) {
+        chain = new HookChain(address);
+        s_chains.insert(address, chain);
+        s_ordered.insert(std::lower_bound(
+            s_ordered.begin(), s_ordered.end(), as<uintptr_t>(address), compareAddress
+        ), chain);
+    }
+    return chain;
+}
+
+HookChain* HookChain::find(void* address) {
+    auto chain = s_chains.find(address);
+    if (!chain) {
+        return nullptr;
+    }
+    return *chain;
+}
+
+HookChain* HookChain::of(Hook* hook) {
+    return as<HookChain*>(hook->m_handle);
+}
+
+std::vector<HookChain*> HookChain::getChains() {
+    return s_ordered;
+}
+
+HookChain* HookChain::forVTableSlot(void** slot) {
+    auto chain = s_vtableSlots.find(as<uintptr_t>(slot));
+    if (!chain) {
+        return nullptr;
+    }
+    return *chain;
+}
+
+std::vector<HookChain*> HookChain::findInRange(void* address, size_t size) {
+    // a chain overlaps the range if its 
+    // footprint ends past the start of the 
+    // range and it starts before its end
+    auto start = as<uintptr_t>(address);
+    auto first = start > s_footprint ? start - s_footprint + 1 : 0;
+    auto it = std::lower_bound(s_ordered.begin(), s_ordered.end(), first, compareAddress);
+
+    std::vector<HookChain*> res;
+    for (; it != s_ordered.end() && as<uintptr_t>((*it)->m_address) < start + size; it++) {
+        res.push_back(*it);
+    }
+    return res;
+}
+
+Result<> HookChain::createStub(void** stub) {
+    if (!this->m_entry && stub != &this->m_entry) {
+        auto entry = this->createStub(&this->m_entry);
+        if (!entry) return entry;
+    }
+    // the hook engine jumps into the entry 
+    // stub from the hooked function
+    auto mem = as<uint8_t*>(ExecutableMemory::allocate(s_stubSize, this->m_address));
+    if (!mem) {
+        return Err<>("Unable to allocate executable memory for hook stub");
+    }
+    writeStub(mem, this->m_address);
+    ExecutableMemory::flush(mem, s_stubSize);
+    *stub = mem;
+    return Ok<>();
+}
+
+Result<> HookChain::createWrapper(Link& link) {
+    if (link.m_wrapper) {
+        return Ok<>();
+    }
+    auto stats = new HookCounters;
+    auto wrapper = HookInstrumentation::createWrapper(link.m_hook->m_detour, stats);
+    if (!wrapper) {
+        delete stats;
+        return Err<>("Unable to create instrumentation wrapper");
+    }
+    link.m_wrapper = wrapper;
+    link.m_hook->m_stats = stats;
+    this->m_wrappers.push_back({ wrapper, stats });
+    return Ok<>();
+}
+
+HookChain::Link* HookChain::linkFor(Hook* hook) {
+    for (auto& link : this->m_links) {
+        if (link.m_hook == hook) {
+            return &link;
+        }
+    }
+    return nullptr;
+}
+
+HookMode HookChain::selectMode() {
+    // once the jump is written it stays for as 
+    // long as any hook wants it, even disabled 
+    // ones, so that toggling hooks doesn't 
+    // rewrite the function under the game
+    auto installedInline = this->m_inline && this->m_inline->isInstalled();
+    auto res = HookMode::Trap;
+    auto wantsTrap = false;
+    auto wantsVirtual = false;
+    for (auto const& link : this->m_links) {
+        auto hook = link.m_hook;
+        if (hook->m_lazy) continue;
+        if (!hook->m_enabled && !installedInline) continue;
+        auto mode = hook->m_mode;
+        if (mode == HookMode::Default) {
+            mode = hook->m_owner ? hook->m_owner->getHookMode() : HookMode::Trap;
+        }
+        // an inline hook catches every call, 
+        // including the ones through imports, 
+        // so it wins over import mode
+        if (mode == HookMode::Inline && this->m_inline) {
+            return HookMode::Inline;
+        }
+        if (mode == HookMode::Import && hook->m_enabled && this->importable()) {
+            res = HookMode::Import;
+        } else if (mode == HookMode::Virtual && this->m_vtableSlots.size()) {
+            wantsVirtual = hook->m_enabled || wantsVirtual;
+        } else {
+            wantsTrap = hook->m_enabled || wantsTrap;
+        }
+    }
+    // virtual table slots are redirected in 
+    // every mode, so the function itself only 
+    // needs a hook if some other hook wants one
+    if (res == HookMode::Trap && wantsVirtual && !wantsTrap) {
+        return HookMode::Virtual;
+    }
+    return res;
+}
+
+bool HookChain::importable() {
+    if (!this->m_import && !this->m_unimportable && this->m_entry) {
+        auto hook = ImportHook::create(this->m_address, this->m_entry);
+        if (hook) {
+            this->m_import = hook.value();
+        } else {
+            this->m_unimportable = true;
+        }
+    }
+    return this->m_import;
+}
+
+Result<> HookChain::setVTablesInstalled(bool installed) {
+    if (this->m_vtablesInstalled == installed) {
+        return Ok<>();
+    }
+    auto from = installed ? this->m_address : this->m_entry;
+    auto to = installed ? this->m_entry : this->m_address;
+    PageUnprotect unprotect;
+    for (auto const& slot : this->m_vtableSlots) {
+        if (*slot != from) continue;
+        if (!unprotect.add(slot, sizeof(void*))) {
+            return Err<>("Unable to unprotect virtual table");
+        }
+        // single aligned pointer store, so 
+        // a virtual call sees either the old 
+        // or the new target
+        *slot = to;
+    }
+    this->m_vtablesInstalled = installed;
+    return Ok<>();
+}
+
+Result<> HookChain::install(HookMode mode) {
+    if (mode == HookMode::Inline) {
+        auto res = this->m_inline->install();
+        if (!res) return res;
+    } else if (mode == HookMode::Import) {
+        auto res = this->m_import->install();
+        if (!res) {
+            this->m_import->uninstall();
+            return res;
+        }
+    } else if (mode != HookMode::Virtual) {
+        #ifndef LILAC_IS_WINDOWS
+        // the posix trap handler can't step over 
+        // its own trap, so the chain has to be 
+        // able to continue into the relocated 
+        // prologue instead of the hooked function
+        if (!this->m_inline) {
+            return Err<>(
+                "Unable to create trap hook: the start of the function "
+                "can't be relocated"
+            );
+        }
+        #endif
+        this->m_handle = lilac::core::hook::add(this->m_address, this->m_entry);
+        if (!this->m_handle) {
+            return Err<>("Unable to create hook");
+        }
+    }
+    this->m_mode = mode;
+
+    auto res = this->setVTablesInstalled(true);
+    if (!res) {
+        this->uninstall();
+        return res;
+    }
+    return Ok<>();
+}
+
+Result<> HookChain::uninstall() {
+    auto vtables = this->setVTablesInstalled(false);
+    if (!vtables) return vtables;
+
+    if (this->m_handle) {
+        if (!lilac::core::hook::remove(this->m_handle)) {
+            return Err<>("Unable to remove hook");
+        }
+        this->m_handle = nullptr;
+    }
+    if (this->m_inline) {
+        auto res = this->m_inline->uninstall();
+        if (!res) return res;
+    }
+    if (this->m_import) {
+        auto res = this->m_import->uninstall();
+        if (!res) return res;
+    }
+    return Ok<>();
+}
+
+Result<> HookChain::relocate() {
+    if (this->m_inline || this->m_unrelocatable || !this->m_entry) {
+        return Ok<>();
+    }
+    // the prologue has to be relocated 
+    // as it is, without a hook in it
+    auto res = this->uninstall();
+    if (!res) return res;
+    auto hook = InlineHook::create(this->m_address, this->m_entry);
+    if (hook) {
+        this->m_inline = hook.value();
+    } else {
+        // not fatal on windows; trap hooks 
+        // work on anything there, they just 
+        // have to continue through the trap
+        this->m_unrelocatable = true;
+    }
+    return Ok<>();
+}
+
+Result<> HookChain::publish() {
+    auto res = this->relocate();
+    if (!res) return res;
+
+    auto mode = this->selectMode();
+    // the chain continues into the relocated 
+    // prologue, which jumps back into the 
+    // function past the hook, so calling the 
+    // original never goes through the hook 
+    // again and never has to lift it
+    void* original = this->m_inline ? 
+        this->m_inline->getOriginal() : 
+        this->m_address;
+
+    auto instrumented = HookInstrumentation::isEnabled();
+    auto detourOf = [&](Link const& link) -> void* {
+        if (instrumented && link.m_wrapper) {
+            return link.m_wrapper;
+        }
+        return link.m_hook->m_detour;
+    };
+
+    // the entry stub goes to the first 
+    // enabled detour
+    void* entry = original;
+    for (auto const& link : this->m_links) {
+        if (link.m_hook->m_enabled) {
+            entry = detourOf(link);
+            break;
+        }
+    }
+
+    auto shouldInstall = entry != original || (
+        mode == HookMode::Inline && this->m_inline->isInstalled()
+    );
+
+    // the entry stub must never point back 
+    // at the hooked function while the hook 
+    // is in it, so uninstall before storing 
+    // and install after. switching modes 
+    // goes through being uninstalled too
+    auto installed = this->isInstalled();
+    if (installed && (!shouldInstall || mode != this->m_mode)) {
+        auto res = this->uninstall();
+        if (!res) return res;
+        installed = false;
+    }
+
+    // walk the chain backwards: every link 
+    // continues into the next enabled detour 
+    // after it, and the last one continues 
+    // into the original function. disabled 
+    // links still get a continuation so that 
+    // a detour that is being disabled while 
+    // running can still call its trampoline. 
+    // removed links keep theirs for the same 
+    // reason until their stub is reclaimed, 
+    // see ExecutableMemory::retire
+    void* next = original;
+    for (auto link = this->m_links.rbegin(); link != this->m_links.rend(); link++) {
+        setTarget(link->m_stub, next);
+        if (link->m_hook->m_enabled) {
+            next = detourOf(*link);
+        }
+    }
+    setTarget(this->m_entry, entry);
+
+    if (shouldInstall && !installed) {
+        return this->install(mode);
+    }
+    this->m_mode = mode;
+    return Ok<>();
+}
+
+Result<void*> HookChain::add(Hook* hook) {
+    Link link { hook };
+    auto stub = this->createStub(&link.m_stub);
+    if (!stub) {
+        return Err<>(stub.error());
+    }
+
+    // insert after every link of the 
+    // same or a higher priority
+    auto pos = this->m_links.begin();
+    while (pos != this->m_links.end() && pos->m_hook->m_priority >= hook->m_priority) {
+        pos++;
+    }
+    pos = this->m_links.insert(pos, link);
+    hook->m_handle = this;
+
+    if (HookInstrumentation::isEnabled()) {
+        // not fatal; the hook just won't 
+        // show up in the stats
+        this->createWrapper(*pos);
+    }
+
+    auto res = this->publish();
+    if (!res) {
+        return Err<>(res.error());
+    }
+    return Ok<void*>(link.m_stub);
+}
+
+Result<> HookChain::enable(Hook* hook) {
+    if (!this->linkFor(hook)) {
+        return Err<>("Hook is not part of this hook chain");
+    }
+    if (hook->m_enabled) {
+        return Ok<>();
+    }
+    hook->m_enabled = true;
+    auto res = this->publish();
+    if (!res) {
+        hook->m_enabled = false;
+        this->publish();
+    }
+    return res;
+}
+
+Result<> HookChain::disable(Hook* hook) {
+    if (!this->linkFor(hook)) {
+        return Err<>("Hook is not part of this hook chain");
+    }
+    if (!hook->m_enabled) {
+        return Ok<>();
+    }
+    hook->m_enabled = false;
+    auto res = this->publish();
+    if (!res) {
+        hook->m_enabled = true;
+        this->publish();
+    }
+    return res;
+}
+
+Result<> HookChain::remove(Hook* hook) {
+    auto res = this->disable(hook);
+    if (!res) {
+        return res;
+    }
+    void* stub = nullptr;
+    for (auto link = this->m_links.begin(); link != this->m_links.end(); link++) {
+        if (link->m_hook == hook) {
+            stub = link->m_stub;
+            this->m_links.erase(link);
+            break;
+        }
+    }
+    hook->m_handle = nullptr;
+    hook->m_stats = nullptr;
+    res = this->publish();
+    // nothing links to the stub anymore, but 
+    // the detour may still be about to call 
+    // it. stubs of hooks removed long enough 
+    // ago are given back while at it
+    ExecutableMemory::retire(stub);
+    ExecutableMemory::reclaim();
+    return res;
+}
+
+Result<> HookChain::addVTableSlot(void** slot) {
+    if (HookChain::forVTableSlot(slot)) {
+        return Ok<>();
+    }
+    if (*slot != this->m_address) {
+        return Err<>("Virtual table slot doesn't point to the hooked function");
+    }
+    this->m_vtableSlots.push_back(slot);
+    s_vtableSlots.insert(as<uintptr_t>(slot), this);
+    if (this->m_vtablesInstalled) {
+        this->m_vtablesInstalled = false;
+        return this->setVTablesInstalled(true);
+    }
+    return Ok<>();
+}
+
+Result<> HookChain::setInstrumented(bool instrumented) {
+    if (instrumented) {
+        for (auto& link : this->m_links) {
+            auto res = this->createWrapper(link);
+            if (!res) return res;
+        }
+    }
+    return this->publish();
+}
+
+void* HookChain::getAddress() const {
+    return this->m_address;
+}
+
+bool HookChain::isInstalled() const {
+    return 
+        this->m_handle || 
+        this->m_vtablesInstalled || 
+        (this->m_inline && this->m_inline->isInstalled()) ||
+        (this->m_import && this->m_import->isInstalled());
+}
+
+HookMode HookChain::getMode() const {
+    return this->m_mode;
+}
+
+std::vector<Hook*> HookChain::getHooks() const {
+    std::vector<Hook*> res;
+    for (auto const& link : this->m_links) {
+        res.push_back(link.m_hook);
+    }
+    return res;
+}
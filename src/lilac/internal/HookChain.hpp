@@ -0,0 +1,272 @@
+#pragma once
+
+#include <Hook.hpp>
+#include <Mod.hpp>
+#include <atomic>
+#include <vector>
+#include "AddressMap.hpp"
+#include "InlineHook.hpp"
+#include "ImportHook.hpp"
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Every hook placed on a single address.
+ * 
+ * Only one hook is ever installed into the 
+ * hooked function itself, and it points to 
+ * the chain's entry stub. The entry stub and 
+ * the trampoline stub of every detour are an 
+ * indirect jump through a pointer stored 
+ * right after the jump, which is where the 
+ * stub continues to. Whenever a hook is 
+ * enabled, disabled or removed, the pointers 
+ * are rewritten in place, one aligned store 
+ * each. Toggling a hook therefore never 
+ * rewrites code that the game may be 
+ * executing at the same time, allocates 
+ * nothing, and touches no registers. 
+ * 
+ * A call racing a toggle may read some 
+ * pointers from before it and some from 
+ * after, but every pointer only ever 
+ * leads further down the chain, so such a 
+ * call just skips or includes the toggled 
+ * detour and still ends up in the original.
+ * 
+ * Detours are called in order of descending 
+ * priority; hooks with the same priority are 
+ * called in the order they were added. The 
+ * last detour in the chain continues into 
+ * the original function through a copy of 
+ * its relocated prologue, so the hook stays 
+ * in place while the original runs and other 
+ * threads can keep calling the function.
+ * 
+ * The hook into the function itself is 
+ * either a trap or an inline jump. Inline 
+ * is used as soon as one enabled hook asks 
+ * for it, unless the function's prologue 
+ * can't be relocated, in which case the 
+ * chain stays in trap mode for good. 
+ * Otherwise, if a hook asks for import 
+ * mode and the function is imported by 
+ * some module, the function is left alone 
+ * and its imports are pointed to the 
+ * entry stub instead. 
+ * 
+ * Virtual table slots registered with the 
+ * chain are pointed to the entry stub 
+ * whenever the chain is installed, in any 
+ * mode, so virtual calls skip the trap. If 
+ * every enabled hook is a virtual hook, the 
+ * function itself isn't touched at all.
+ * 
+ * Chains are never destroyed. A thread may 
+ * be running in the chain's entry stub, 
+ * wrappers or relocated prologue at any 
+ * time, even after its last hook is removed, 
+ * and there is no way to tell when it's 
+ * done, so that memory is never freed or 
+ * handed to anything else. A chain whose 
+ * last hook is removed is uninstalled and 
+ * waits to be reused if the address is 
+ * hooked again. The trampoline stub of a 
+ * removed hook can only be reached by its 
+ * own detour, so it's retired to 
+ * ExecutableMemory and reclaimed once it's 
+ * quiescent.
+ * @class HookChain
+ */
+class HookChain {
+    protected:
+        struct Link {
+            Hook*  m_hook;
+            // trampoline stub; jumps to the 
+            // continuation
+            void*  m_stub;
+            // instrumentation wrapper around 
+            // the detour, if one was created
+            void*  m_wrapper = nullptr;
+        };
+
+        void* m_address;
+        const void* m_handle = nullptr;
+        void* m_entry = nullptr;
+        /**
+         * The relocated prologue, which is where 
+         * the chain continues into the original 
+         * function in either mode, and the inline 
+         * hook if the chain is in inline mode
+         */
+        InlineHook* m_inline = nullptr;
+        /**
+         * Set if the prologue couldn't be 
+         * relocated. The chain is then stuck in 
+         * trap mode and continues into the 
+         * hooked function itself, which the hook 
+         * engine deals with by lifting the trap.
+         */
+        bool m_unrelocatable = false;
+        /**
+         * Import hook pointing the function's 
+         * imports to the entry stub, created 
+         * once a hook asks for import mode
+         */
+        ImportHook* m_import = nullptr;
+        /**
+         * Set if no loaded module imported the 
+         * function when import mode was first 
+         * asked for; those hooks fall back to 
+         * trap mode
+         */
+        bool m_unimportable = false;
+        /**
+         * Virtual table slots that point to the 
+         * function, and whether they currently 
+         * point to the entry stub instead
+         */
+        std::vector<void**> m_vtableSlots;
+        bool m_vtablesInstalled = false;
+        HookMode m_mode = HookMode::Trap;
+        /**
+         * Links in call order
+         */
+        std::vector<Link> m_links;
+        /**
+         * Instrumentation wrappers & the stats 
+         * they write to. Unlike the stubs, a 
+         * call may still be returning through 
+         * a wrapper for as long as its detour 
+         * runs after its hook is gone, so 
+         * these are kept.
+         */
+        std::vector<std::pair<void*, HookCounters*>> m_wrappers;
+
+        /**
+         * Every chain by address, for lookups
+         */
+        static AddressMap<HookChain*> s_chains;
+        /**
+         * Every chain sorted by address, for 
+         * range queries
+         */
+        static std::vector<HookChain*> s_ordered;
+        /**
+         * Every chain by registered virtual 
+         * table slot
+         */
+        static AddressMap<HookChain*> s_vtableSlots;
+
+        HookChain(void* address);
+
+        /**
+         * Create a stub that continues to the 
+         * original function for now, and the 
+         * entry stub if there isn't one yet
+         */
+        Result<> createStub(void** stub);
+        Result<> createWrapper(Link& link);
+        Link* linkFor(Hook* hook);
+        /**
+         * Pick the mode to install in based on 
+         * what the enabled hooks want
+         */
+        HookMode selectMode();
+        /**
+         * Create the import hook, if that 
+         * hasn't been done or tried yet
+         * @returns True if the chain can be 
+         * installed in import mode
+         */
+        bool importable();
+        /**
+         * Relocate the prologue, if that 
+         * hasn't been done or tried yet
+         */
+        Result<> relocate();
+        Result<> setVTablesInstalled(bool installed);
+        Result<> install(HookMode mode);
+        Result<> uninstall();
+        Result<> publish();
+
+    public:
+        /**
+         * Amount of bytes at the start of a hooked 
+         * function that the hook engine may 
+         * overwrite; the size of a rel32 jmp
+         */
+        static constexpr const size_t s_footprint = 5;
+
+        /**
+         * Get the chain for an address, creating 
+         * it if it doesn't exist yet
+         */
+        static HookChain* get(void* address);
+        /**
+         * Get the chain for an address, or 
+         * nullptr if nothing hooks it
+         */
+        static HookChain* find(void* address);
+        /**
+         * Get the chain a hook belongs to, or 
+         * nullptr if it hasn't been added to one
+         */
+        static HookChain* of(Hook* hook);
+        static std::vector<HookChain*> getChains();
+        /**
+         * Get every chain whose hooked bytes 
+         * overlap the given range, in order 
+         * of address
+         */
+        static std::vector<HookChain*> findInRange(void* address, size_t size);
+        /**
+         * Get the chain a virtual table slot has 
+         * been registered with, or nullptr if 
+         * it hasn't been
+         */
+        static HookChain* forVTableSlot(void** slot);
+
+        /**
+         * Add a hook to the chain in its priority 
+         * order. The hook starts out disabled.
+         * @returns Successful result containing 
+         * the hook's trampoline, which continues 
+         * down the chain, errorful result with 
+         * info on error
+         */
+        Result<void*> add(Hook* hook);
+        Result<> enable(Hook* hook);
+        Result<> disable(Hook* hook);
+        Result<> remove(Hook* hook);
+
+        /**
+         * Register a virtual table slot that 
+         * points to the hooked function. The 
+         * slot is redirected to the chain for 
+         * as long as the chain is installed.
+         */
+        Result<> addVTableSlot(void** slot);
+
+        /**
+         * Route calls through (or stop routing 
+         * them through) instrumentation wrappers
+         */
+        Result<> setInstrumented(bool instrumented);
+
+        void* getAddress() const;
+        bool isInstalled() const;
+        /**
+         * Get the mode the chain is (or would 
+         * be) installed in
+         */
+        HookMode getMode() const;
+        std::vector<Hook*> getHooks() const;
+
+        // see above
+        ~HookChain() = delete;
+
+        // no copying
+        HookChain(HookChain const&) = delete;
+        HookChain operator=(HookChain const&) = delete;
+};
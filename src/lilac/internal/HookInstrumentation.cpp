@@ -0,0 +1,323 @@
+#include "HookInstrumentation.hpp"
+#include "HookChain.hpp"
+#include "Memory.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define LILAC_STATS_CALL __cdecl
+#else
+    #include <x86intrin.h>
+    #define LILAC_STATS_CALL
+#endif
+
+static bool g_instrumented = false;
+// time over which the current stats have 
+// been collected, not counting the time 
+// that's still running since `g_since`
+static std::chrono::steady_clock::duration g_measured {};
+static std::chrono::steady_clock::time_point g_since;
+
+struct stats_frame {
+    HookCounters* stats;
+    void*      ret;
+    uint64_t   start;
+};
+
+static thread_local std::vector<stats_frame> g_frames;
+
+static size_t log2Floor(uint64_t value) {
+    #ifdef _MSC_VER
+        unsigned long ix;
+        if (value >> 32) {
+            _BitScanReverse(&ix, static_cast<unsigned long>(value >> 32));
+            return ix + 32;
+        }
+        _BitScanReverse(&ix, static_cast<unsigned long>(value));
+        return ix;
+    #else
+        return 63 - __builtin_clzll(value);
+    #endif
+}
+
+// called from the wrapper stubs
+
+static void LILAC_STATS_CALL enterDetour(HookCounters* stats, void* ret) {
+    g_frames.push_back({ stats, ret, __rdtsc() });
+}
+
+static void* LILAC_STATS_CALL leaveDetour() {
+    auto end = __rdtsc();
+    auto frame = g_frames.back();
+    g_frames.pop_back();
+
+    frame.stats->record(end - frame.start);
+    return frame.ret;
+}
+
+void HookCounters::record(uint64_t ticks) {
+    static constexpr auto relaxed = std::memory_order_relaxed;
+
+    m_calls.fetch_add(1, relaxed);
+    m_totalTicks.fetch_add(ticks, relaxed);
+    // only contended while a new extreme 
+    // is being set, which is rare
+    auto min = m_minTicks.load(relaxed);
+    while (ticks < min && !m_minTicks.compare_exchange_weak(min, ticks, relaxed)) {}
+    auto max = m_maxTicks.load(relaxed);
+    while (ticks > max && !m_maxTicks.compare_exchange_weak(max, ticks, relaxed)) {}
+    m_histogram[ticks ? log2Floor(ticks) : 0].fetch_add(1, relaxed);
+}
+
+HookStats HookCounters::load() const {
+    static constexpr auto relaxed = std::memory_order_relaxed;
+
+    HookStats stats;
+    stats.m_calls = m_calls.load(relaxed);
+    stats.m_totalTicks = m_totalTicks.load(relaxed);
+    stats.m_minTicks = m_minTicks.load(relaxed);
+    stats.m_maxTicks = m_maxTicks.load(relaxed);
+    for (size_t i = 0; i < 64; i++) {
+        stats.m_histogram[i] = m_histogram[i].load(relaxed);
+    }
+    return stats;
+}
+
+void HookCounters::reset() {
+    static constexpr auto relaxed = std::memory_order_relaxed;
+
+    m_calls.store(0, relaxed);
+    m_totalTicks.store(0, relaxed);
+    m_minTicks.store(UINT64_MAX, relaxed);
+    m_maxTicks.store(0, relaxed);
+    for (auto& bucket : m_histogram) {
+        bucket.store(0, relaxed);
+    }
+}
+
+// Wrapper stub layout:
+// 
+// wrapper:
+//     save argument registers
+//     enterDetour(stats, [return address])
+//     restore argument registers
+//     replace return address with `exit`
+//     jmp detour
+// exit:
+//     save return value registers
+//     [return address] = leaveDetour()
+//     restore return value registers
+//     ret
+// 
+// The stub is assembled twice: once with no 
+// base address to find out its size and 
+// where `exit` is, and once into the 
+// allocated memory.
+
+struct stub_writer {
+    uint8_t* m_base;
+    size_t   m_exit;
+    std::vector<uint8_t> m_code;
+
+    void put(std::initializer_list<uint8_t> bytes) {
+        m_code.insert(m_code.end(), bytes);
+    }
+    void put32(uint32_t value) {
+        auto bytes = as<uint8_t*>(&value);
+        m_code.insert(m_code.end(), bytes, bytes + 4);
+    }
+    void putPtr(const void* ptr) {
+        auto bytes = as<const uint8_t*>(&ptr);
+        m_code.insert(m_code.end(), bytes, bytes + sizeof(ptr));
+    }
+    uintptr_t exit() const {
+        return as<uintptr_t>(m_base) + m_exit;
+    }
+    void markExit() {
+        m_exit = m_code.size();
+    }
+};
+
+#if defined(_M_IX86) || defined(__i386__)
+
+static void assembleWrapper(stub_writer& w, void* detour, HookCounters* stats) {
+    w.put({ 0x51 });                            // push ecx
+    w.put({ 0x52 });                            // push edx
+    w.put({ 0xFF, 0x74, 0x24, 0x08 });          // push [esp + 8]
+    w.put({ 0x68 }); w.putPtr(stats);           // push stats
+    w.put({ 0xB8 }); w.putPtr(as<void*>(&enterDetour)); // mov eax, enterDetour
+    w.put({ 0xFF, 0xD0 });                      // call eax
+    w.put({ 0x83, 0xC4, 0x08 });                // add esp, 8
+    w.put({ 0x5A });                            // pop edx
+    w.put({ 0x59 });                            // pop ecx
+    w.put({ 0xC7, 0x04, 0x24 });                // mov [esp], exit
+    w.put32(static_cast<uint32_t>(w.exit()));
+    w.put({ 0xB8 }); w.putPtr(detour);          // mov eax, detour
+    w.put({ 0xFF, 0xE0 });                      // jmp eax
+
+    w.markExit();
+    w.put({ 0x50 });                            // push eax (slot for the return address)
+    w.put({ 0x50 });                            // push eax
+    w.put({ 0x52 });                            // push edx
+    w.put({ 0xB8 }); w.putPtr(as<void*>(&leaveDetour)); // mov eax, leaveDetour
+    w.put({ 0xFF, 0xD0 });                      // call eax
+    w.put({ 0x89, 0x44, 0x24, 0x08 });          // mov [esp + 8], eax
+    w.put({ 0x5A });                            // pop edx
+    w.put({ 0x58 });                            // pop eax
+    w.put({ 0xC3 });                            // ret
+}
+
+#elif defined(_M_X64) || defined(__x86_64__)
+
+static void putXmm(stub_writer& w, bool store, uint8_t reg, uint32_t disp) {
+    // movdqu [rsp + disp], xmm / movdqu xmm, [rsp + disp]
+    w.put({ 0xF3, 0x0F, static_cast<uint8_t>(store ? 0x7F : 0x6F) });
+    w.put({ static_cast<uint8_t>(0x84 | (reg << 3)), 0x24 });
+    w.put32(disp);
+}
+
+static void assembleWrapper(stub_writer& w, void* detour, HookCounters* stats) {
+    // 8 saved registers + 8 saved xmm registers, 
+    // 32 bytes of shadow space and padding to 
+    // keep the stack 16-byte aligned for the call
+    static constexpr const uint32_t frame = 32 + 8 * 16 + 8;
+
+    w.put({ 0x51, 0x52, 0x56, 0x57 });          // push rcx, rdx, rsi, rdi
+    w.put({ 0x41, 0x50, 0x41, 0x51 });          // push r8, r9
+    w.put({ 0x50, 0x41, 0x52 });                // push rax, r10
+    w.put({ 0x48, 0x81, 0xEC }); w.put32(frame);// sub rsp, frame
+    for (uint8_t i = 0; i < 8; i++) {
+        putXmm(w, true, i, 32 + i * 16);
+    }
+    #ifdef _WIN64
+    w.put({ 0x48, 0xB9 }); w.putPtr(stats);     // mov rcx, stats
+    w.put({ 0x48, 0x8B, 0x94, 0x24 });          // mov rdx, [rsp + return address]
+    #else
+    w.put({ 0x48, 0xBF }); w.putPtr(stats);     // mov rdi, stats
+    w.put({ 0x48, 0x8B, 0xB4, 0x24 });          // mov rsi, [rsp + return address]
+    #endif
+    w.put32(frame + 8 * 8);
+    w.put({ 0x48, 0xB8 }); w.putPtr(as<void*>(&enterDetour)); // mov rax, enterDetour
+    w.put({ 0xFF, 0xD0 });                      // call rax
+    for (uint8_t i = 0; i < 8; i++) {
+        putXmm(w, false, i, 32 + i * 16);
+    }
+    w.put({ 0x48, 0x81, 0xC4 }); w.put32(frame);// add rsp, frame
+    w.put({ 0x41, 0x5A, 0x58 });                // pop r10, rax
+    w.put({ 0x41, 0x59, 0x41, 0x58 });          // pop r9, r8
+    w.put({ 0x5F, 0x5E, 0x5A, 0x59 });          // pop rdi, rsi, rdx, rcx
+
+    w.put({ 0x49, 0xBB }); w.putPtr(as<void*>(w.exit())); // mov r11, exit
+    w.put({ 0x4C, 0x89, 0x1C, 0x24 });          // mov [rsp], r11
+    w.put({ 0x49, 0xBB }); w.putPtr(detour);    // mov r11, detour
+    w.put({ 0x41, 0xFF, 0xE3 });                // jmp r11
+
+    w.markExit();
+    w.put({ 0x50, 0x50, 0x52 });                // push rax (slot), rax, rdx
+    w.put({ 0x48, 0x83, 0xEC, 0x48 });          // sub rsp, 72
+    putXmm(w, true, 0, 32);
+    putXmm(w, true, 1, 48);
+    w.put({ 0x48, 0xB8 }); w.putPtr(as<void*>(&leaveDetour)); // mov rax, leaveDetour
+    w.put({ 0xFF, 0xD0 });                      // call rax
+    putXmm(w, false, 0, 32);
+    putXmm(w, false, 1, 48);
+    w.put({ 0x48, 0x83, 0xC4, 0x48 });          // add rsp, 72
+    w.put({ 0x48, 0x89, 0x44, 0x24, 0x10 });    // mov [rsp + 16], rax
+    w.put({ 0x5A, 0x58 });                      // pop rdx, rax
+    w.put({ 0xC3 });                            // ret
+}
+
+#else
+    #error "Hook instrumentation is not implemented for this architecture"
+#endif
+
+void* HookInstrumentation::createWrapper(void* detour, HookCounters* stats) {
+    stub_writer measure { nullptr, 0 };
+    assembleWrapper(measure, detour, stats);
+
+    auto mem = as<uint8_t*>(ExecutableMemory::allocate(measure.m_code.size()));
+    if (!mem) return nullptr;
+
+    stub_writer w { mem, measure.m_exit };
+    assembleWrapper(w, detour, stats);
+    memcpy(mem, w.m_code.data(), w.m_code.size());
+    ExecutableMemory::flush(mem, w.m_code.size());
+    return mem;
+}
+
+bool HookInstrumentation::isEnabled() {
+    return g_instrumented;
+}
+
+Result<> HookInstrumentation::setEnabled(bool enabled) {
+    if (g_instrumented == enabled) return Ok<>();
+    g_instrumented = enabled;
+    if (enabled) {
+        // calibrate now rather than in the 
+        // middle of dumping
+        HookInstrumentation::ticksPerMicrosecond();
+        g_since = std::chrono::steady_clock::now();
+    } else {
+        g_measured += std::chrono::steady_clock::now() - g_since;
+    }
+    Result<> res = Ok<>();
+    for (auto const& chain : HookChain::getChains()) {
+        auto set = chain->setInstrumented(enabled);
+        if (!set && res) {
+            res = set;
+        }
+    }
+    return res;
+}
+
+HookStats Hook::getStats() const {
+    if (this->m_stats) {
+        return this->m_stats->load();
+    }
+    return HookStats();
+}
+
+void HookInstrumentation::reset() {
+    for (auto const& chain : HookChain::getChains()) {
+        for (auto const& hook : chain->getHooks()) {
+            if (hook->m_stats) {
+                hook->m_stats->reset();
+            }
+        }
+    }
+    g_measured = {};
+    g_since = std::chrono::steady_clock::now();
+}
+
+double HookInstrumentation::callRate(HookStats const& stats) {
+    auto measured = g_measured;
+    if (g_instrumented) {
+        measured += std::chrono::steady_clock::now() - g_since;
+    }
+    auto seconds = std::chrono::duration<double>(measured).count();
+    return seconds > 0.0 ? stats.m_calls / seconds : 0.0;
+}
+
+HookMode HookInstrumentation::recommendMode(Hook* hook) {
+    if (HookInstrumentation::callRate(hook->getStats()) >= s_inlineCallRate) {
+        return HookMode::Inline;
+    }
+    return HookMode::Trap;
+}
+
+double HookInstrumentation::ticksPerMicrosecond() {
+    static auto g_ticks = []() -> double {
+        auto startTime = std::chrono::steady_clock::now();
+        auto startTicks = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto ticks = __rdtsc() - startTicks;
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime
+        ).count();
+        return time ? static_cast<double>(ticks) / time : 1.0;
+    }();
+    return g_ticks;
+}
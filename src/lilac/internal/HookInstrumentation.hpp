@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Hook.hpp>
+#include <Mod.hpp>
+#include <atomic>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * What the wrapper stubs record a hook's 
+ * calls into. A detour can be running on 
+ * any number of threads at once, so every 
+ * field is updated atomically; relaxed, as 
+ * nothing else is ordered against them. 
+ * Read through `Hook::getStats`.
+ */
+struct HookCounters {
+    std::atomic<uint64_t> m_calls {};
+    std::atomic<uint64_t> m_totalTicks {};
+    std::atomic<uint64_t> m_minTicks { UINT64_MAX };
+    std::atomic<uint64_t> m_maxTicks {};
+    std::atomic<uint64_t> m_histogram[64] {};
+
+    void record(uint64_t ticks);
+    HookStats load() const;
+    void reset();
+};
+
+/**
+ * Opt-in per-hook call counters & latency 
+ * histograms.
+ * 
+ * While enabled, every hook chain routes 
+ * calls to its detours through a wrapper 
+ * stub that reads the TSC before the detour 
+ * runs and after it returns, and records the 
+ * result in the hook's HookCounters. The return 
+ * address is swapped out for the wrapper's 
+ * exit stub and kept on a thread-local 
+ * shadow stack, so the detour sees the same 
+ * arguments and stack layout as without the 
+ * wrapper, whatever its calling convention.
+ * 
+ * While disabled, the chains' jump tables 
+ * point straight at the detours again, so 
+ * the cost is exactly zero.
+ * 
+ * Detours that are unwound through by 
+ * exceptions or longjmp will desync the 
+ * shadow stack; this is a profiling tool.
+ * @class HookInstrumentation
+ */
+class HookInstrumentation {
+    public:
+        static bool isEnabled();
+        /**
+         * Turn instrumentation on or off for 
+         * every hook chain
+         * @returns Error if some chain couldn't 
+         * switch; the rest still do
+         */
+        static Result<> setEnabled(bool enabled);
+
+        /**
+         * Zero the statistics of every hook
+         */
+        static void reset();
+
+        /**
+         * TSC ticks per microsecond, measured 
+         * the first time this is called
+         */
+        static double ticksPerMicrosecond();
+
+        /**
+         * Calls per second above which a hook 
+         * is better off inline; around this 
+         * point trap dispatch starts costing 
+         * milliseconds every second
+         */
+        static constexpr const double s_inlineCallRate = 1000.0;
+
+        /**
+         * Calls per second to a hook since stats 
+         * were last turned on or reset
+         */
+        static double callRate(HookStats const& stats);
+
+        /**
+         * Recommend a hook mode based on how 
+         * often the hook has been called
+         * @returns HookMode::Inline if the hook is 
+         * called often enough for trap dispatch 
+         * to matter, HookMode::Trap if not
+         */
+        static HookMode recommendMode(Hook* hook);
+
+        /**
+         * Create a wrapper stub that records 
+         * calls to `detour` into `stats`
+         * @returns Pointer to the stub, or 
+         * nullptr if one couldn't be created
+         */
+        static void* createWrapper(void* detour, HookCounters* stats);
+};
@@ -0,0 +1,105 @@
+#include "HookTable.hpp"
+#include "AddressTable.hpp"
+#include "InternalMod.hpp"
+#include <Log.hpp>
+
+// The table is everything between these two 
+// markers (MSVC sorts grouped sections by the 
+// part after the $) or the linker-generated 
+// start & stop symbols of the section.
+#ifdef _MSC_VER
+    #pragma section(".lilac$ha", read)
+    #pragma section(".lilac$hz", read)
+    __declspec(allocate(".lilac$ha"))
+    extern hook_descriptor const* const g_hookTableBegin = nullptr;
+    __declspec(allocate(".lilac$hz"))
+    extern hook_descriptor const* const g_hookTableEnd = nullptr;
+
+    static hook_descriptor const* const* tableBegin() { return &g_hookTableBegin + 1; }
+    static hook_descriptor const* const* tableEnd()   { return &g_hookTableEnd; }
+#elif defined(__APPLE__)
+    extern hook_descriptor const* const g_hookTableBegin[]
+        __asm("section$start$__DATA$lilac_hooks");
+    extern hook_descriptor const* const g_hookTableEnd[]
+        __asm("section$end$__DATA$lilac_hooks");
+
+    static hook_descriptor const* const* tableBegin() { return g_hookTableBegin; }
+    static hook_descriptor const* const* tableEnd()   { return g_hookTableEnd; }
+#else
+    // weak, so that a build without any 
+    // hooks (and so no section) still links
+    extern "C" hook_descriptor const* const __start_lilac_hooks[] __attribute__((weak));
+    extern "C" hook_descriptor const* const __stop_lilac_hooks[] __attribute__((weak));
+
+    static hook_descriptor const* const* tableBegin() { return __start_lilac_hooks; }
+    static hook_descriptor const* const* tableEnd()   { return __stop_lilac_hooks; }
+#endif
+
+std::vector<hook_descriptor const*> HookTable::getDescriptors() {
+    std::vector<hook_descriptor const*> res;
+    auto begin = tableBegin();
+    auto end = tableEnd();
+    if (!begin || !end) {
+        return res;
+    }
+    for (auto entry = begin; entry < end; entry++) {
+        if (*entry) {
+            res.push_back(*entry);
+        }
+    }
+    return res;
+}
+
+size_t HookTable::load() {
+    auto descriptors = HookTable::getDescriptors();
+
+    // resolve everything first
+    std::vector<std::pair<hook_descriptor const*, uintptr_t>> resolved;
+    resolved.reserve(descriptors.size());
+    for (auto const& desc : descriptors) {
+        if (desc->m_address) {
+            auto addr = desc->m_address();
+            if (!addr) {
+                InternalMod::get()->throwError(
+                    "Hook has no address on this platform", Severity::Critical
+                );
+                continue;
+            }
+            resolved.push_back({ desc, addr });
+            continue;
+        }
+        if (!desc->m_module) {
+            auto addr = AddressTable::addressOf(desc->m_symbol);
+            if (!addr) {
+                InternalMod::get()->throwError(
+                    "No address for " + std::string(desc->m_symbol.m_name) + 
+                    " in this game build", Severity::Critical
+                );
+                continue;
+            }
+            resolved.push_back({ desc, addr });
+            continue;
+        }
+        auto addr = SymbolResolver::get()->resolve(desc->m_module, desc->m_symbol);
+        if (!addr) {
+            InternalMod::get()->throwError(addr.error(), Severity::Critical);
+            continue;
+        }
+        resolved.push_back({ desc, addr.value() });
+    }
+
+    size_t count = 0;
+    for (auto const& [desc, address] : resolved) {
+        auto res = InternalMod::get()->addHook(as<void*>(address), desc->m_detour());
+        if (!res) {
+            InternalMod::get()->throwError(res.error(), Severity::Critical);
+            continue;
+        }
+        count++;
+    }
+
+    InternalMod::get()->log()
+        << Severity::Debug << "Added " << count << " of "
+        << descriptors.size() << " internal hooks" << lilac::endl;
+    return count;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Mod.hpp>
+#include "SymbolResolver.hpp"
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * A hook declared by lilac itself. Built 
+ * entirely at compile time and placed in a 
+ * dedicated linker section, so declaring a 
+ * hook runs no code at DLL load.
+ */
+struct hook_descriptor {
+    /**
+     * Returns the detour; a function so 
+     * that the descriptor stays constexpr
+     */
+    void* (*m_detour)();
+    /**
+     * Returns the address to hook, or 
+     * nullptr to resolve `m_symbol` in 
+     * `m_module` instead; or if there's no 
+     * module either, to look `m_symbol` up 
+     * in the game's AddressTable
+     */
+    uintptr_t (*m_address)();
+    const char* m_module;
+    symbol_name m_symbol;
+};
+
+template <auto Detour>
+void* hookDetourOf() {
+    return as<void*>(Detour);
+}
+
+// Section entries are pointers to the 
+// descriptors rather than the descriptors 
+// themselves, since the MSVC linker may 
+// pad grouped sections with zeroes; null 
+// entries are skipped.
+#ifdef _MSC_VER
+    #pragma section(".lilac$hb", read)
+    #define LILAC_HOOK_TABLE_ENTRY(_name_)                       \
+        extern hook_descriptor const* const _name_;              \
+        __declspec(allocate(".lilac$hb"))                        \
+        hook_descriptor const* const _name_
+#elif defined(__APPLE__)
+    #define LILAC_HOOK_TABLE_ENTRY(_name_)                       \
+        __attribute__((used, section("__DATA,lilac_hooks")))     \
+        static hook_descriptor const* const _name_
+#else
+    #define LILAC_HOOK_TABLE_ENTRY(_name_)                       \
+        __attribute__((used, section("lilac_hooks")))            \
+        static hook_descriptor const* const _name_
+#endif
+
+#define LILAC_HOOK_DESCRIPTOR(_name_, _detour_, _address_, _module_, _symbol_)\
+    static constexpr hook_descriptor _name_##_descriptor {                   \
+        &hookDetourOf<_detour_>, _address_, _module_, _symbol_               \
+    };                                                                       \
+    LILAC_HOOK_TABLE_ENTRY(_name_) = &_name_##_descriptor
+
+/**
+ * Every hook declared with the CREATE_HOOK 
+ * macros. The table is only read when hooks 
+ * are loaded, in one go, so every address 
+ * is resolved and checked before any hook 
+ * is added.
+ * @class HookTable
+ */
+class HookTable {
+    public:
+        static std::vector<hook_descriptor const*> getDescriptors();
+
+        /**
+         * Resolve the address of every hook in 
+         * the table and add them to the internal 
+         * mod. Hooks whose address can't be 
+         * resolved are reported & skipped.
+         * @returns Amount of hooks added
+         */
+        static size_t load();
+};
@@ -0,0 +1,139 @@
+#include "HookTransaction.hpp"
+#include "HookChain.hpp"
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstring>
+#include <core/hook/hook.hpp>
+
+void HookTransaction::begin() {
+    if (this->m_open) {
+        this->rollback();
+    }
+    this->m_entries.clear();
+    this->m_open = true;
+    this->m_failedMod = nullptr;
+}
+
+void HookTransaction::add(Mod* owner, Hook* hook) {
+    hook->m_owner = owner;
+    this->m_entries.push_back({ owner, hook });
+}
+
+Result<> HookTransaction::commit() {
+    if (!this->m_open) {
+        return Err<>("No hook transaction in progress");
+    }
+
+    // install in address order so that hooks 
+    // sharing a page are written back-to-back
+    std::stable_sort(
+        this->m_entries.begin(), this->m_entries.end(),
+        [](Entry const& a, Entry const& b) -> bool {
+            return a.m_hook->getAddress() < b.m_hook->getAddress();
+        }
+    );
+
+    // the hook engine's own writes go through 
+    // these pages too, so each page is only 
+    // unprotected once for the whole batch
+    PageBatch pages;
+    for (auto& entry : this->m_entries) {
+        if (!pages.add(entry.m_hook->m_address, s_snapshotSize)) {
+            return this->fail(entry, "Unable to unprotect memory");
+        }
+    }
+
+    for (auto& entry : this->m_entries) {
+        if (!lilac::core::hook::read_memory(
+            entry.m_hook->m_address, entry.m_original, s_snapshotSize
+        )) {
+            return this->fail(entry, "Unable to read memory");
+        }
+        if (!entry.m_hook->m_handle) {
+            auto link = HookChain::get(entry.m_hook->m_address)->add(entry.m_hook);
+            if (!link) {
+                return this->fail(entry, link.error());
+            }
+        }
+        auto res = HookChain::of(entry.m_hook)->enable(entry.m_hook);
+        if (!res) {
+            return this->fail(entry, res.error());
+        }
+        entry.m_installed = true;
+    }
+
+    this->release();
+    return Ok<>();
+}
+
+Result<> HookTransaction::fail(Entry const& entry, std::string const& error) {
+    // the entry goes away with the rollback
+    auto addr = entry.m_hook->getAddress();
+    auto count = this->m_entries.size();
+    this->m_failedMod = entry.m_mod;
+    this->rollback();
+    return Err<>(
+        "Unable to create hook at " + std::to_string(addr) + 
+        ": " + error + ", rolled back " + 
+        std::to_string(count) + " hooks"
+    );
+}
+
+Mod* HookTransaction::getFailedMod() const {
+    return this->m_failedMod;
+}
+
+void HookTransaction::undo() {
+    PageBatch pages;
+    // remove in reverse order so that hooks stacked 
+    // on the same address unwind correctly and the 
+    // first snapshot taken is the last one restored
+    for (auto entry = this->m_entries.rbegin(); entry != this->m_entries.rend(); entry++) {
+        if (!entry->m_installed) continue;
+
+        pages.add(entry->m_hook->m_address, s_snapshotSize);
+        auto chain = HookChain::of(entry->m_hook);
+        chain->disable(entry->m_hook);
+        entry->m_installed = false;
+
+        // other hooks outside the transaction 
+        // may still be using the address
+        if (chain->isInstalled()) continue;
+
+        uint8_t current[s_snapshotSize];
+        if (
+            !lilac::core::hook::read_memory(
+                entry->m_hook->m_address, current, s_snapshotSize
+            ) ||
+            memcmp(current, entry->m_original, s_snapshotSize)
+        ) {
+            lilac::core::hook::write_memory(
+                entry->m_hook->m_address, entry->m_original, s_snapshotSize
+            );
+        }
+    }
+}
+
+void HookTransaction::release() {
+    this->m_entries.clear();
+    this->m_open = false;
+}
+
+void HookTransaction::rollback() {
+    this->undo();
+    this->release();
+}
+
+size_t HookTransaction::size() const {
+    return this->m_entries.size();
+}
+
+bool HookTransaction::isOpen() const {
+    return this->m_open;
+}
+
+HookTransaction::~HookTransaction() {
+    if (this->m_open) {
+        this->rollback();
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Hook.hpp>
+#include <Mod.hpp>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Installs a batch of hooks as a single unit. 
+ * Hooks are queued with `add` and written on 
+ * `commit` in address order, with every page 
+ * they're on made writable once up front and 
+ * restored once at the end; the hook engine's 
+ * own writes reuse those pages instead of 
+ * changing protection per hook. If any 
+ * hook fails to install, every hook already 
+ * installed by the transaction is removed 
+ * again and the original bytes are restored, 
+ * so the process is never left half-hooked.
+ * @class HookTransaction
+ */
+class HookTransaction {
+    protected:
+        /**
+         * Amount of bytes at the start of each 
+         * hooked function that are snapshotted 
+         * before installing, so they can be 
+         * restored on rollback. Comfortably 
+         * larger than anything the hook 
+         * engine writes.
+         */
+        static constexpr const size_t s_snapshotSize = 16;
+
+        struct Entry {
+            Mod*    m_mod;
+            Hook*   m_hook;
+            bool    m_installed = false;
+            uint8_t m_original[s_snapshotSize];
+        };
+
+        std::vector<Entry> m_entries;
+        bool m_open = false;
+        Mod* m_failedMod = nullptr;
+
+        void undo();
+        void release();
+        Result<> fail(Entry const& entry, std::string const& error);
+
+    public:
+        /**
+         * Start a new transaction. Any hooks 
+         * still queued from a previous, 
+         * uncommitted transaction are rolled 
+         * back first.
+         */
+        void begin();
+
+        /**
+         * Queue a hook to be installed on commit. 
+         * The hook's address & detour must 
+         * already be populated.
+         */
+        void add(Mod* owner, Hook* hook);
+
+        /**
+         * Install every queued hook.
+         * @returns Successful result if all hooks 
+         * were installed, errorful result with 
+         * info on the first failure otherwise. 
+         * On failure the transaction has been 
+         * rolled back.
+         */
+        Result<> commit();
+
+        /**
+         * Get the owner of the hook that made 
+         * the last commit fail
+         * @returns The mod, or nullptr if the 
+         * last commit didn't fail or the hook 
+         * had no owner
+         */
+        Mod* getFailedMod() const;
+
+        /**
+         * Remove every hook installed by this 
+         * transaction and hand all queued hooks 
+         * back to their owners as disabled.
+         */
+        void rollback();
+
+        size_t size() const;
+        bool isOpen() const;
+
+        HookTransaction() = default;
+        ~HookTransaction();
+
+        // no copying
+        HookTransaction(HookTransaction const&) = delete;
+        HookTransaction operator=(HookTransaction const&) = delete;
+};
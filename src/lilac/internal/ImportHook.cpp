@@ -0,0 +1,66 @@
+#include "ImportHook.hpp"
+#include "Memory.hpp"
+#include <algorithm>
+
+ImportHook::ImportHook(void* function, void* destination)
+  : m_function(function), m_destination(destination) {}
+
+Result<ImportHook*> ImportHook::create(void* function, void* destination) {
+    std::vector<void**> slots;
+    ImportHook::findSlots(function, slots);
+    if (slots.empty()) {
+        return Err<>("Function is not imported by any loaded module");
+    }
+    return Ok(new ImportHook(function, destination));
+}
+
+Result<> ImportHook::install() {
+    std::vector<void**> slots;
+    ImportHook::findSlots(this->m_function, slots);
+
+    PageUnprotect unprotect;
+    for (auto const& slot : slots) {
+        auto known = std::find_if(
+            this->m_slots.begin(), this->m_slots.end(),
+            [slot](import_slot const& s) { return s.m_address == slot; }
+        );
+        if (known != this->m_slots.end()) continue;
+        if (!unprotect.add(slot, sizeof(void*))) {
+            return Err<>("Unable to unprotect import table");
+        }
+        this->m_slots.push_back({ slot, *slot });
+        // an aligned pointer store is atomic, 
+        // so a thread calling through the 
+        // slot sees either the old or the new 
+        // target and nothing in between
+        *slot = this->m_destination;
+    }
+    return Ok<>();
+}
+
+Result<> ImportHook::uninstall() {
+    PageUnprotect unprotect;
+    for (auto const& slot : this->m_slots) {
+        // leave slots someone else has 
+        // redirected since alone
+        if (*slot.m_address != this->m_destination) continue;
+        if (!unprotect.add(slot.m_address, sizeof(void*))) {
+            return Err<>("Unable to unprotect import table");
+        }
+        *slot.m_address = slot.m_original;
+    }
+    this->m_slots.clear();
+    return Ok<>();
+}
+
+bool ImportHook::isInstalled() const {
+    return this->m_slots.size();
+}
+
+size_t ImportHook::getSlotCount() const {
+    return this->m_slots.size();
+}
+
+ImportHook::~ImportHook() {
+    this->uninstall();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <inttypes.h>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * A hook that redirects the import table 
+ * entries (the IAT on Windows, the GOT on 
+ * ELF platforms) that point to an exported 
+ * function, in every loaded module.
+ * 
+ * The function itself is never modified, so 
+ * calling it directly runs the original, and 
+ * each entry is switched with a single 
+ * pointer store. Only calls that go through 
+ * an import are hooked though: calls from 
+ * inside the module that exports the 
+ * function, virtual calls and calls from 
+ * modules loaded after the hook was 
+ * installed bypass it.
+ * @class ImportHook
+ */
+class ImportHook {
+    protected:
+        struct import_slot {
+            void** m_address;
+            // what the slot held before it was 
+            // redirected; not always the function, 
+            // as lazily bound slots point to a 
+            // resolver stub until first called
+            void*  m_original;
+        };
+
+        void* m_function;
+        void* m_destination;
+        std::vector<import_slot> m_slots;
+
+        ImportHook(void* function, void* destination);
+
+        // platform-specific
+        /**
+         * Find every import table entry in the 
+         * loaded modules that refers to `function`
+         */
+        static void findSlots(void* function, std::vector<void**>& slots);
+
+    public:
+        /**
+         * Create an import hook. Does not 
+         * install the hook yet.
+         * @returns Successful result containing 
+         * the hook, errorful result if no loaded 
+         * module imports the function
+         */
+        static Result<ImportHook*> create(void* function, void* destination);
+
+        /**
+         * Redirect every import of the function, 
+         * including ones in modules loaded since 
+         * the hook was created
+         */
+        Result<> install();
+        Result<> uninstall();
+
+        bool isInstalled() const;
+        size_t getSlotCount() const;
+
+        ~ImportHook();
+
+        // no copying
+        ImportHook(ImportHook const&) = delete;
+        ImportHook operator=(ImportHook const&) = delete;
+};
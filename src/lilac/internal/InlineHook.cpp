@@ -0,0 +1,197 @@
+#include "InlineHook.hpp"
+#include "Disassembler.hpp"
+#include "Memory.hpp"
+#include <cstring>
+#include <vector>
+
+static bool fitsRel32(intptr_t offset) {
+    return offset >= INT32_MIN && offset <= INT32_MAX;
+}
+
+// write a rel32 jmp into `buffer` that will 
+// jump to `to` once it's placed at `at`
+static void writeJump(uint8_t* buffer, void* at, void* to) {
+    auto rel = static_cast<int32_t>(
+        as<intptr_t>(to) - as<intptr_t>(as<uint8_t*>(at) + 5)
+    );
+    buffer[0] = 0xE9;
+    memcpy(buffer + 1, &rel, 4);
+}
+
+InlineHook::InlineHook(void* address, void* destination)
+  : m_address(address), m_destination(destination) {}
+
+Result<InlineHook*> InlineHook::create(void* address, void* destination) {
+    if (!ExecutableMemory::isNear(destination, 0, address)) {
+        return Err<>("Hook destination is out of rel32 range");
+    }
+    auto hook = new InlineHook(address, destination);
+    auto res = hook->relocate();
+    if (!res) {
+        delete hook;
+        return Err<>(res.error());
+    }
+    return Ok(hook);
+}
+
+Result<> InlineHook::relocate() {
+    auto src = as<uint8_t*>(this->m_address);
+
+    // find the instructions that will be 
+    // overwritten
+    std::vector<instruction_info> instrs;
+    size_t size = 0;
+    size_t worstCase = 0;
+    while (size < s_jumpSize) {
+        instruction_info info;
+        if (!Disassembler::decode(src + size, info)) {
+            return Err<>("Unknown instruction in function prologue");
+        }
+        size += info.m_length;
+        // widening a short branch adds 
+        // up to 4 bytes
+        worstCase += info.m_length + 4;
+        instrs.push_back(info);
+        // anything after this may not 
+        // belong to the function at all
+        if (info.m_endsFlow && size < s_jumpSize) {
+            return Err<>("Function is too short to be hooked inline");
+        }
+    }
+    if (size > s_maxPatchSize) {
+        return Err<>("Function prologue is too long");
+    }
+    this->m_patchSize = size;
+    memcpy(this->m_original, src, size);
+
+    this->m_trampolineSize = worstCase + s_jumpSize;
+    this->m_trampoline = as<uint8_t*>(
+        ExecutableMemory::allocate(this->m_trampolineSize, this->m_address)
+    );
+    if (!this->m_trampoline) {
+        return Err<>("Unable to allocate executable memory for trampoline");
+    }
+
+    auto patchStart = as<intptr_t>(src);
+    auto patchEnd = patchStart + static_cast<intptr_t>(size);
+    auto isPatched = [&](intptr_t target) {
+        return target > patchStart && target < patchEnd;
+    };
+
+    auto dst = this->m_trampoline;
+    size_t offset = 0;
+    for (auto const& info : instrs) {
+        auto from = src + offset;
+        auto fromNext = as<intptr_t>(from + info.m_length);
+
+        if (info.m_relSize == 1) {
+            auto target = fromNext + static_cast<int8_t>(from[info.m_relOffset]);
+            if (info.m_opcode >= 0xE0 && info.m_opcode <= 0xE3) {
+                // loop / jecxz have no rel32 form
+                return Err<>("Unable to relocate short loop in function prologue");
+            }
+            if (isPatched(target)) {
+                return Err<>("Function prologue branches into itself");
+            }
+            // copy any prefixes, then the 
+            // rel32 form of the branch
+            auto prefixes = info.m_relOffset - 1;
+            memcpy(dst, from, prefixes);
+            dst += prefixes;
+            if (info.m_opcode == 0xEB) {
+                *dst++ = 0xE9;
+            } else {
+                *dst++ = 0x0F;
+                *dst++ = 0x80 | (info.m_opcode & 0x0F);
+            }
+            auto rel = target - as<intptr_t>(dst + 4);
+            if (!fitsRel32(rel)) {
+                return Err<>("Relocated branch is out of rel32 range");
+            }
+            auto rel32 = static_cast<int32_t>(rel);
+            memcpy(dst, &rel32, 4);
+            dst += 4;
+        }
+        else {
+            memcpy(dst, from, info.m_length);
+            auto toNext = as<intptr_t>(dst + info.m_length);
+
+            // both rel32 branches and rip-relative 
+            // operands are relative to the end 
+            // of the instruction
+            auto fix = info.m_relSize == 4 ? info.m_relOffset : info.m_ripOffset;
+            if (fix) {
+                int32_t disp;
+                memcpy(&disp, from + fix, 4);
+                auto target = fromNext + disp;
+                if (info.m_relSize == 4 && isPatched(target)) {
+                    return Err<>("Function prologue branches into itself");
+                }
+                auto rel = target - toNext;
+                if (!fitsRel32(rel)) {
+                    return Err<>("Relocated operand is out of rel32 range");
+                }
+                disp = static_cast<int32_t>(rel);
+                memcpy(dst + fix, &disp, 4);
+            }
+            dst += info.m_length;
+        }
+        offset += info.m_length;
+    }
+    writeJump(dst, dst, src + size);
+    ExecutableMemory::flush(this->m_trampoline, this->m_trampolineSize);
+    return Ok<>();
+}
+
+Result<> InlineHook::write(const uint8_t* bytes) {
+    PageUnprotect pages;
+    if (!pages.add(this->m_address, this->m_patchSize)) {
+        return Err<>("Unable to unprotect hooked function");
+    }
+    memcpy(this->m_address, bytes, this->m_patchSize);
+    pages.restore();
+    ExecutableMemory::flush(this->m_address, this->m_patchSize);
+    return Ok<>();
+}
+
+Result<> InlineHook::install() {
+    if (this->m_installed) {
+        return Ok<>();
+    }
+    // pad the rest of the overwritten 
+    // instructions with int3 so that a 
+    // stray jump into them is caught
+    uint8_t patch[s_maxPatchSize];
+    memset(patch, 0xCC, this->m_patchSize);
+    writeJump(patch, this->m_address, this->m_destination);
+
+    auto res = this->write(patch);
+    if (!res) return res;
+    this->m_installed = true;
+    return Ok<>();
+}
+
+Result<> InlineHook::uninstall() {
+    if (!this->m_installed) {
+        return Ok<>();
+    }
+    auto res = this->write(this->m_original);
+    if (!res) return res;
+    this->m_installed = false;
+    return Ok<>();
+}
+
+void* InlineHook::getOriginal() const {
+    return this->m_trampoline;
+}
+
+bool InlineHook::isInstalled() const {
+    return this->m_installed;
+}
+
+InlineHook::~InlineHook() {
+    this->uninstall();
+    if (this->m_trampoline) {
+        ExecutableMemory::free(this->m_trampoline);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <inttypes.h>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * A hook that overwrites the start of the 
+ * hooked function with a rel32 jmp to the 
+ * destination.
+ * 
+ * The instructions that get overwritten are 
+ * moved into a trampoline, followed by a 
+ * jump back to the first instruction after 
+ * them, so that calling the trampoline runs 
+ * the original function. Relative branches 
+ * and rip-relative operands are rewritten 
+ * to still point to the same place; short 
+ * branches are widened to rel32.
+ * 
+ * Unlike trap hooks, calls to an inline hook 
+ * never go through an exception handler, 
+ * which makes them a lot cheaper for 
+ * functions that are called often.
+ * @class InlineHook
+ */
+class InlineHook {
+    protected:
+        static constexpr const size_t s_maxPatchSize = 32;
+
+        void*   m_address;
+        void*   m_destination;
+        uint8_t* m_trampoline = nullptr;
+        size_t  m_trampolineSize = 0;
+        /**
+         * Amount of bytes overwritten; always 
+         * covers whole instructions
+         */
+        size_t  m_patchSize = 0;
+        uint8_t m_original[s_maxPatchSize];
+        bool    m_installed = false;
+
+        InlineHook(void* address, void* destination);
+
+        Result<> relocate();
+        Result<> write(const uint8_t* bytes);
+
+    public:
+        /**
+         * Size of the jump written to the 
+         * hooked function
+         */
+        static constexpr const size_t s_jumpSize = 5;
+
+        /**
+         * Create the trampoline for an inline 
+         * hook. Does not install the hook yet.
+         * @param destination Where the hook jumps 
+         * to; must be within rel32 range of 
+         * `address`
+         * @returns Successful result containing 
+         * the hook, errorful result with info on 
+         * why the start of the function can't 
+         * be relocated
+         */
+        static Result<InlineHook*> create(void* address, void* destination);
+
+        Result<> install();
+        Result<> uninstall();
+
+        /**
+         * Get the trampoline, which calls 
+         * the original function
+         */
+        void* getOriginal() const;
+        bool isInstalled() const;
+
+        ~InlineHook();
+
+        // no copying
+        InlineHook(InlineHook const&) = delete;
+        InlineHook operator=(InlineHook const&) = delete;
+};
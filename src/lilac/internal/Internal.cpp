@@ -5,10 +5,71 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 #include "InternalMod.hpp"
 #include <Log.hpp>
 #include <Loader.hpp>
 #include <CLIManager.hpp>
+#include "HookChain.hpp"
+#include "HookInstrumentation.hpp"
+#include "SymbolResolver.hpp"
+
+// statistics of every hook owned by a loaded 
+// mod as a table, ordered by total time spent
+static std::string dumpHookStats() {
+    struct row {
+        Mod* mod;
+        Hook* hook;
+        HookStats stats;
+    };
+    std::vector<row> rows;
+    auto mods = Loader::get()->getLoadedMods();
+    mods.insert(mods.begin(), InternalMod::get());
+    for (auto const& mod : mods) {
+        for (auto const& hook : mod->getHooks()) {
+            rows.push_back({ mod, hook, hook->getStats() });
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](row const& a, row const& b) -> bool {
+        return a.stats.m_totalTicks > b.stats.m_totalTicks;
+    });
+
+    auto perUs = HookInstrumentation::ticksPerMicrosecond();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Hook statistics (" << (HookInstrumentation::isEnabled() ? "on" : "off") << ")\n";
+    for (auto const& row : rows) {
+        auto const& stats = row.stats;
+        ss << "  " << row.mod->getName() << " @ 0x"
+           << std::hex << row.hook->getAddress() << std::dec
+           << ": " << stats.m_calls << " calls";
+        if (stats.m_calls) {
+            ss << ", total " << stats.m_totalTicks / perUs << "us"
+               << ", avg " << stats.m_totalTicks / perUs / stats.m_calls << "us"
+               << ", min " << stats.m_minTicks / perUs << "us"
+               << ", max " << stats.m_maxTicks / perUs << "us"
+               << ", " << HookInstrumentation::callRate(stats) << " calls/s";
+        }
+        auto chain = HookChain::of(row.hook);
+        if (chain && chain->isInstalled()) {
+            auto mode = chain->getMode();
+            ss << " [" << (
+                mode == HookMode::Inline ? "inline" : 
+                mode == HookMode::Import ? "import" : 
+                mode == HookMode::Virtual ? "virtual" : "trap"
+            ) << "]";
+            if (
+                mode == HookMode::Trap && 
+                HookInstrumentation::recommendMode(row.hook) == HookMode::Inline
+            ) {
+                ss << " (hot; consider HookMode::Inline)";
+            }
+        }
+        ss << "\n";
+    }
+    return ss.str();
+}
 
 Lilac::Lilac() {
     // init KeybindManager & load default keybinds
@@ -43,6 +104,14 @@ bool Lilac::setup() {
     InternalMod::get()->log()
         << Severity::Debug << "Loaded hooks" << lilac::endl;
 
+    // every built-in hook has been resolved by 
+    // now, so this is the last chance to add 
+    // anything to the symbol cache
+    auto cache = SymbolResolver::get()->saveCache();
+    if (!cache) {
+        InternalMod::get()->throwError(cache.error(), Severity::Warning);
+    }
+
     InternalMod::get()->addKeybindAction(TriggerableAction {
         "Yeetus Feetus",
         "lilac.yeetus",
@@ -109,6 +178,59 @@ void Lilac::awaitPlatformConsole() {
         Loader::get()->updateMods();
     }
 
+    // hookstats [on | off | reset]
+    if (args.size() && args[0] == "hookstats") {
+        if (args.size() > 1) {
+            Result<> res = Ok<>();
+            if (args[1] == "on") {
+                res = HookInstrumentation::setEnabled(true);
+            } else if (args[1] == "off") {
+                res = HookInstrumentation::setEnabled(false);
+            } else if (args[1] == "reset") {
+                HookInstrumentation::reset();
+            }
+            if (!res) {
+                InternalMod::get()->throwError(res.error(), Severity::Warning);
+            }
+        }
+        std::cout << dumpHookStats();
+    }
+
+    // hooks <address> [size]
+    if (args.size() > 1 && args[0] == "hooks") {
+        auto address = std::strtoull(args[1].c_str(), nullptr, 16);
+        auto size = args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 16) : 1;
+        auto hooks = Loader::get()->getHooksInRange(address, size);
+        if (hooks.empty()) {
+            std::cout << "Nothing hooks " << args[1] << "\n";
+        }
+        for (auto const& hook : hooks) {
+            std::cout
+                << std::hex << hook->getAddress() << std::dec << ": "
+                << hook->getOwner()->getID()
+                << " (priority " << hook->getPriority()
+                << (hook->isEnabled() ? "" : ", disabled") << ")\n";
+        }
+    }
+
+    // patches <address> [size]
+    if (args.size() > 1 && args[0] == "patches") {
+        auto address = std::strtoull(args[1].c_str(), nullptr, 16);
+        auto size = args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 16) : 1;
+        auto patches = Loader::get()->getPatchesInRange(address, size);
+        if (patches.empty()) {
+            std::cout << "Nothing patches " << args[1] << "\n";
+        }
+        for (auto const& patch : patches) {
+            std::cout
+                << std::hex << patch->getAddress() << std::dec << ": "
+                << patch->getOwner()->getID()
+                << " (" << patch->getSize() << " bytes"
+                << (patch->isApplied() ? "" : ", not applied")
+                << (patch->verify() ? "" : ", overwritten") << ")\n";
+        }
+    }
+
     if (inp != "e") this->awaitPlatformConsole();
 }
 
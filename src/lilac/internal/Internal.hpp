@@ -23,6 +23,12 @@ class Lilac {
         bool setup();
 
         bool loadHooks();
+        /**
+         * Whether a lazy hook trigger has been 
+         * fired, so hooks waiting on it can be 
+         * installed
+         */
+        bool hasFiredHookTrigger(std::string const& trigger) const;
 
         bool platformConsoleReady() const;
         void queueConsoleMessage(LogMessage*);
@@ -0,0 +1,233 @@
+#include "Memory.hpp"
+#include "AddressMap.hpp"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+uintptr_t PageUnprotect::pageOf(uintptr_t address) {
+    return address - address % PageUnprotect::pageSize();
+}
+
+static thread_local PageBatch* g_batch = nullptr;
+
+bool PageUnprotect::add(void* address, size_t size) {
+    auto batch = PageBatch::current();
+    if (batch && &batch->m_pages != this) {
+        return batch->add(address, size);
+    }
+
+    auto start = PageUnprotect::pageOf(as<uintptr_t>(address));
+    auto end   = as<uintptr_t>(address) + (size ? size : 1);
+    for (auto page = start; page < end; page += PageUnprotect::pageSize()) {
+        // writes in order of address hit the 
+        // last page added over and over
+        if (this->m_pages.size() && this->m_pages.back().m_address == page) continue;
+        if (this->m_known.count(page)) continue;
+
+        auto info = Page { page, 0 };
+        if (!PageUnprotect::unprotectPage(info)) {
+            return false;
+        }
+        this->m_pages.push_back(info);
+        this->m_known.insert(page);
+    }
+    return true;
+}
+
+void PageUnprotect::restore() {
+    for (auto const& page : this->m_pages) {
+        PageUnprotect::restorePage(page);
+    }
+    this->m_pages.clear();
+    this->m_known.clear();
+}
+
+size_t PageUnprotect::getPageCount() const {
+    return this->m_pages.size();
+}
+
+PageUnprotect::~PageUnprotect() {
+    this->restore();
+}
+
+PageBatch* PageBatch::current() {
+    return g_batch;
+}
+
+PageBatch::PageBatch() {
+    if (!g_batch) {
+        g_batch = this;
+        this->m_active = true;
+    }
+}
+
+bool PageBatch::add(void* address, size_t size) {
+    if (!this->m_active) {
+        return g_batch->add(address, size);
+    }
+    return this->m_pages.add(address, size);
+}
+
+size_t PageBatch::getPageCount() const {
+    return this->m_active ? this->m_pages.getPageCount() : g_batch->getPageCount();
+}
+
+PageBatch::~PageBatch() {
+    if (this->m_active) {
+        g_batch = nullptr;
+        this->m_pages.restore();
+    }
+}
+
+struct exec_slab {
+    uint8_t* m_base;
+    size_t   m_size;
+    // bump pointer for never used memory
+    size_t   m_used = 0;
+    // bytes currently handed out
+    size_t   m_live = 0;
+    // freed blocks, by size
+    std::unordered_map<size_t, std::vector<void*>> m_free;
+
+    bool contains(void* memory) const {
+        return memory >= this->m_base && memory < this->m_base + this->m_size;
+    }
+};
+
+struct retired_block {
+    void* m_block;
+    std::chrono::steady_clock::time_point m_time;
+};
+
+static std::mutex g_execLock;
+static std::vector<exec_slab*> g_slabs;
+static AddressMap<size_t> g_blockSizes;
+// in order of retirement
+static std::vector<retired_block> g_retired;
+
+bool ExecutableMemory::isNear(void* memory, size_t size, void* near) {
+    if (!near) return true;
+    auto start = as<uintptr_t>(memory);
+    auto end = start + size;
+    auto target = as<uintptr_t>(near);
+    return
+        (start > target ? start - target : target - start) < s_maxDistance &&
+        (end > target ? end - target : target - end) < s_maxDistance;
+}
+
+void* ExecutableMemory::allocate(size_t size, void* near) {
+    std::lock_guard<std::mutex> lock(g_execLock);
+
+    size = (std::max<size_t>(size, 1) + s_blockAlign - 1) / s_blockAlign * s_blockAlign;
+
+    // reuse a freed block of the same size 
+    // first, then leftover space in a slab
+    exec_slab* target = nullptr;
+    void* block = nullptr;
+    for (auto const& slab : g_slabs) {
+        if (!ExecutableMemory::isNear(slab->m_base, slab->m_size, near)) continue;
+
+        auto freed = slab->m_free.find(size);
+        if (freed != slab->m_free.end() && freed->second.size()) {
+            block = freed->second.back();
+            freed->second.pop_back();
+            target = slab;
+            break;
+        }
+        if (!target && slab->m_size - slab->m_used >= size) {
+            target = slab;
+        }
+    }
+
+    if (!target) {
+        auto slabSize = (size + s_slabSize - 1) / s_slabSize * s_slabSize;
+        auto pages = ExecutableMemory::reservePages(near, slabSize);
+        if (!pages) return nullptr;
+        if (!ExecutableMemory::isNear(pages, slabSize, near)) {
+            ExecutableMemory::releasePages(pages, slabSize);
+            return nullptr;
+        }
+        target = new exec_slab { as<uint8_t*>(pages), slabSize };
+        g_slabs.push_back(target);
+    }
+
+    if (!block) {
+        block = target->m_base + target->m_used;
+        target->m_used += size;
+    }
+    target->m_live += size;
+    g_blockSizes.insert(block, size);
+    return block;
+}
+
+void ExecutableMemory::free(void* memory) {
+    if (!memory) return;
+
+    std::lock_guard<std::mutex> lock(g_execLock);
+
+    auto size = g_blockSizes.find(memory);
+    if (!size) return;
+    auto blockSize = *size;
+    g_blockSizes.erase(memory);
+
+    for (auto slab = g_slabs.begin(); slab != g_slabs.end(); slab++) {
+        if (!(*slab)->contains(memory)) continue;
+
+        (*slab)->m_live -= blockSize;
+        if (!(*slab)->m_live) {
+            ExecutableMemory::releasePages((*slab)->m_base, (*slab)->m_size);
+            delete *slab;
+            g_slabs.erase(slab);
+        } else {
+            (*slab)->m_free[blockSize].push_back(memory);
+        }
+        return;
+    }
+}
+
+void ExecutableMemory::retire(void* memory) {
+    if (!memory) return;
+
+    std::lock_guard<std::mutex> lock(g_execLock);
+    g_retired.push_back({ memory, std::chrono::steady_clock::now() });
+}
+
+size_t ExecutableMemory::reclaim(std::chrono::milliseconds grace) {
+    std::vector<void*> quiescent;
+    {
+        std::lock_guard<std::mutex> lock(g_execLock);
+        // the oldest blocks are at the front, 
+        // so the quiescent ones are too
+        auto cutoff = std::chrono::steady_clock::now() - grace;
+        auto end = std::find_if(g_retired.begin(), g_retired.end(),
+            [cutoff](retired_block const& block) -> bool { return block.m_time > cutoff; }
+        );
+        for (auto block = g_retired.begin(); block != end; block++) {
+            quiescent.push_back(block->m_block);
+        }
+        g_retired.erase(g_retired.begin(), end);
+    }
+    for (auto const& block : quiescent) {
+        ExecutableMemory::free(block);
+    }
+    return quiescent.size();
+}
+
+size_t ExecutableMemory::getRetiredCount() {
+    std::lock_guard<std::mutex> lock(g_execLock);
+    return g_retired.size();
+}
+
+size_t ExecutableMemory::getSlabCount() {
+    std::lock_guard<std::mutex> lock(g_execLock);
+    return g_slabs.size();
+}
+
+size_t ExecutableMemory::getAllocatedSize() {
+    std::lock_guard<std::mutex> lock(g_execLock);
+    size_t res = 0;
+    for (auto const& slab : g_slabs) {
+        res += slab->m_live;
+    }
+    return res;
+}
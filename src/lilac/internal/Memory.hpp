@@ -0,0 +1,219 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <utils/casts.hpp>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Makes a set of memory pages writable for 
+ * as long as the object lives, and restores 
+ * their original protection afterwards. 
+ * Used to batch code writes so that page 
+ * protection is flipped once per page 
+ * instead of once per write. While a 
+ * PageBatch is active on the thread, pages 
+ * are added to the batch instead, see 
+ * PageBatch.
+ * @class PageUnprotect
+ */
+class PageUnprotect {
+    protected:
+        struct Page {
+            uintptr_t m_address;
+            uint32_t  m_oldProtection;
+        };
+        std::vector<Page> m_pages;
+        std::unordered_set<uintptr_t> m_known;
+
+        // platform-specific
+        static bool unprotectPage(Page& page);
+        static void restorePage(Page const& page);
+
+    public:
+        static size_t pageSize();
+        static uintptr_t pageOf(uintptr_t address);
+
+        /**
+         * Make every page spanning 
+         * [address, address + size) writable. 
+         * Pages already unprotected by this 
+         * object are skipped.
+         * @returns True if all the pages are 
+         * now writable, false if not
+         */
+        bool add(void* address, size_t size);
+
+        /**
+         * Restore the original protection of 
+         * every page added so far
+         */
+        void restore();
+
+        size_t getPageCount() const;
+
+        PageUnprotect() = default;
+        ~PageUnprotect();
+
+        // no copying
+        PageUnprotect(PageUnprotect const&) = delete;
+        PageUnprotect operator=(PageUnprotect const&) = delete;
+};
+
+/**
+ * Collects the pages of every PageUnprotect 
+ * created on this thread while it lives, 
+ * and restores them all at once when it's 
+ * destroyed. Lets a batch of hooks be 
+ * written with page protection flipped 
+ * once per page in total, even though the 
+ * hook engine unprotects the pages of every 
+ * write it makes. Nested batches join the 
+ * outermost one.
+ * @class PageBatch
+ */
+class PageBatch {
+    protected:
+        PageUnprotect m_pages;
+        bool m_active = false;
+
+        friend class PageUnprotect;
+
+    public:
+        /**
+         * Get the batch active on this thread
+         * @returns The batch, or nullptr if 
+         * there is none
+         */
+        static PageBatch* current();
+
+        /**
+         * Make every page spanning 
+         * [address, address + size) writable 
+         * until the batch ends
+         * @returns True if all the pages are 
+         * now writable, false if not
+         */
+        bool add(void* address, size_t size);
+
+        size_t getPageCount() const;
+
+        PageBatch();
+        ~PageBatch();
+
+        // no copying
+        PageBatch(PageBatch const&) = delete;
+        PageBatch operator=(PageBatch const&) = delete;
+};
+
+/**
+ * Executable memory for small pieces of 
+ * generated code, such as hook stubs.
+ * 
+ * Blocks are carved out of slabs of a few 
+ * pages each, so that stubs for many hooks 
+ * share pages instead of each taking up its 
+ * own. A slab is only handed out for a 
+ * block if it lies within rel32 range of 
+ * the block's target, so a jump from hooked 
+ * code into a stub always fits in five 
+ * bytes. Freed blocks are reused for blocks 
+ * of the same size, and a slab is returned 
+ * to the system once it's empty.
+ * 
+ * Blocks that threads may still jump into, 
+ * such as the stubs of removed hooks, are 
+ * retired instead of freed, and reclaimed 
+ * once they've gone quiescent; see `retire`.
+ * @class ExecutableMemory
+ */
+class ExecutableMemory {
+    protected:
+        /**
+         * Farthest a slab may be from the 
+         * target of a block allocated in it; 
+         * a bit under 2GB
+         */
+        static constexpr const uintptr_t s_maxDistance = 0x7FF00000;
+        static constexpr const size_t s_slabSize = 0x10000;
+        static constexpr const size_t s_blockAlign = 16;
+
+    public:
+        /**
+         * How long a retired block is kept 
+         * before it's considered quiescent
+         */
+        static constexpr const std::chrono::milliseconds s_gracePeriod { 5000 };
+
+    protected:
+
+        // platform-specific
+        static void* reservePages(void* near, size_t size);
+        static void releasePages(void* pages, size_t size);
+
+    public:
+        /**
+         * Allocate executable memory
+         * @param size Size of the block
+         * @param near Address the block must be 
+         * reachable from with a rel32 jump, or 
+         * nullptr if it doesn't matter
+         * @returns The block, or nullptr if no 
+         * memory could be allocated
+         */
+        static void* allocate(size_t size, void* near = nullptr);
+        /**
+         * Free a block. The block may be handed 
+         * out again and its slab unmapped, so 
+         * only free blocks that no thread can 
+         * be running in or jump to anymore; in 
+         * practice, ones that were never made 
+         * reachable from hooked code. Retire 
+         * the rest
+         */
+        static void free(void* memory);
+        /**
+         * Free a block once no thread can be 
+         * running in it or about to jump to it 
+         * anymore. 
+         * 
+         * A hook stub is only ever run for the 
+         * single jump through it, and once its 
+         * hook is removed the only way to reach 
+         * it is the hook's own detour calling 
+         * its trampoline, during a call that 
+         * was already in flight when the hook 
+         * was removed. Lilac can't see those 
+         * calls return, so a retired block is 
+         * considered quiescent after a grace 
+         * period that no detour call should 
+         * come anywhere near, and freed by the 
+         * next `reclaim` after that.
+         */
+        static void retire(void* memory);
+        /**
+         * Free every retired block that has 
+         * been retired for at least `grace`
+         * @returns Amount of blocks freed
+         */
+        static size_t reclaim(std::chrono::milliseconds grace = s_gracePeriod);
+        static size_t getRetiredCount();
+
+        /**
+         * Whether a block at `memory` can be 
+         * reached from `near` with a rel32 jump
+         */
+        static bool isNear(void* memory, size_t size, void* near);
+
+        static size_t getSlabCount();
+        static size_t getAllocatedSize();
+
+        /**
+         * Make sure freshly written code is 
+         * visible to the instruction fetcher
+         */
+        static void flush(void* memory, size_t size);
+};
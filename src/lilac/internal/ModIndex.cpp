@@ -0,0 +1,308 @@
+#include "ModIndex.hpp"
+#include "ArchiveCache.hpp"
+#include <Loader.hpp>
+#include <cstring>
+#include <type_traits>
+
+ModIndex* ModIndex::get() {
+    static auto g_index = new ModIndex;
+    return g_index;
+}
+
+std::filesystem::path ModIndex::getIndexPath() {
+    return std::filesystem::path(lilac_directory) / "mods.index";
+}
+
+static bool statFile(std::string const& path, uint64_t& size, int64_t& time) {
+    std::error_code ec;
+    size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    auto stamp = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    time = static_cast<int64_t>(stamp.time_since_epoch().count());
+    return true;
+}
+
+std::optional<Result<ModInfo>> ModIndex::lookup(std::string const& path) {
+    uint64_t size;
+    int64_t time;
+    if (!statFile(path, size, time)) return std::nullopt;
+
+    std::unique_lock lock(this->m_mutex);
+    if (!this->m_loaded) {
+        this->load();
+    }
+    auto found = this->m_entries.find(path);
+    if (found == this->m_entries.end()) return std::nullopt;
+
+    if (found->second.m_size != size || found->second.m_time != time) {
+        if (found->second.m_size != size) return std::nullopt;
+        // same size but a different time; it 
+        // may just have been touched or copied
+        auto expected = found->second.m_hash;
+        lock.unlock();
+        auto hash = ArchiveCache::hashDirectory(path);
+        if (!hash || hash.value() != expected) return std::nullopt;
+        lock.lock();
+        found = this->m_entries.find(path);
+        if (found == this->m_entries.end() || found->second.m_hash != expected) {
+            return std::nullopt;
+        }
+        found->second.m_time = time;
+        this->m_dirty = true;
+    }
+
+    found->second.m_seen = true;
+    if (found->second.m_error.size()) {
+        return Result<ModInfo>(Err<>(found->second.m_error));
+    }
+    return Result<ModInfo>(Ok<ModInfo>(found->second.m_info));
+}
+
+void ModIndex::store(std::string const& path, Result<ModInfo> const& info) {
+    auto stamp = ArchiveCache::get()->stamp(path);
+    if (!stamp) return;
+    index_entry entry;
+    entry.m_size = stamp.value().m_size;
+    entry.m_time = stamp.value().m_time;
+    entry.m_hash = stamp.value().m_hash;
+    entry.m_seen = true;
+    if (info) {
+        entry.m_info = info.value();
+    } else {
+        entry.m_error = info.error();
+    }
+
+    std::lock_guard lock(this->m_mutex);
+    if (!this->m_loaded) {
+        this->load();
+    }
+    this->m_entries[path] = entry;
+    this->m_dirty = true;
+}
+
+void ModIndex::setBinary(std::string const& path, uint64_t hash) {
+    std::lock_guard lock(this->m_mutex);
+    auto found = this->m_entries.find(path);
+    if (found == this->m_entries.end() || found->second.m_binary == hash) return;
+    found->second.m_binary = hash;
+    this->m_dirty = true;
+}
+
+std::unordered_set<uint64_t> ModIndex::getBinaries() {
+    std::lock_guard lock(this->m_mutex);
+    std::unordered_set<uint64_t> res;
+    for (auto const& [path, entry] : this->m_entries) {
+        if (entry.m_seen && entry.m_binary) {
+            res.insert(entry.m_binary);
+        }
+    }
+    return res;
+}
+
+// Index file layout (little-endian):
+//   u32 magic, u32 version, 
+//   i32 lowest schema, i32 highest schema, u32 count
+//   count * {
+//     str path, u64 size, i64 time, u64 hash, 
+//     u64 binary, str error,
+//     (if error is empty)
+//       str binaryName, VersionInfo version, str id, 
+//       str name, str developer, str description, 
+//       str details, str credits, u8 hookMode, 
+//       u32 dependency count, dependency count * {
+//         str id, VersionInfo version, u8 required
+//       }
+//   }
+// where str is a u32 size followed by that many 
+// bytes, VersionInfo is stored as-is, hash is the 
+// hash of the archive's central directory and 
+// binary is the BinaryCache hash of the mod's 
+// binary, or 0 if there is none
+
+static_assert(
+    std::is_trivially_copyable_v<VersionInfo>,
+    "VersionInfo is written to the mod index as-is"
+);
+
+namespace {
+    struct index_writer {
+        byte_array m_data;
+
+        template <class T>
+        void write(T const& value) {
+            auto bytes = reinterpret_cast<const uint8_t*>(&value);
+            this->m_data.insert(this->m_data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void write(std::string const& str) {
+            this->write(static_cast<uint32_t>(str.size()));
+            this->m_data.insert(this->m_data.end(), str.begin(), str.end());
+        }
+    };
+
+    struct index_reader {
+        byte_array const& m_data;
+        size_t m_pos = 0;
+        bool m_ok = true;
+
+        template <class T>
+        void read(T& value) {
+            if (this->m_pos + sizeof(T) > this->m_data.size()) {
+                this->m_ok = false;
+                return;
+            }
+            memcpy(&value, this->m_data.data() + this->m_pos, sizeof(T));
+            this->m_pos += sizeof(T);
+        }
+
+        void read(std::string& str) {
+            uint32_t size = 0;
+            this->read(size);
+            if (!this->m_ok || this->m_pos + size > this->m_data.size()) {
+                this->m_ok = false;
+                return;
+            }
+            auto start = this->m_data.data() + this->m_pos;
+            str.assign(start, start + size);
+            this->m_pos += size;
+        }
+    };
+}
+
+void ModIndex::load() {
+    this->m_loaded = true;
+
+    auto read = file_utils::readBinary(ModIndex::getIndexPath().string());
+    if (!read) return;
+    auto data = read.value();
+
+    // mods may have been rejected for targeting 
+    // a schema this version of lilac supports, 
+    // or read without fields it knows about
+    index_reader reader { data };
+    uint32_t magic = 0, version = 0, count = 0;
+    int32_t schemaMin = 0, schemaMax = 0;
+    reader.read(magic);
+    reader.read(version);
+    reader.read(schemaMin);
+    reader.read(schemaMax);
+    reader.read(count);
+    if (
+        !reader.m_ok ||
+        magic != s_indexMagic ||
+        version != s_indexVersion ||
+        schemaMin != Loader::s_supportedSchemaMin ||
+        schemaMax != Loader::s_supportedSchemaMax
+    ) return;
+
+    std::unordered_map<std::string, index_entry> entries;
+    for (uint32_t i = 0; i < count && reader.m_ok; i++) {
+        std::string path;
+        index_entry entry;
+        entry.m_seen = false;
+        reader.read(path);
+        reader.read(entry.m_size);
+        reader.read(entry.m_time);
+        reader.read(entry.m_hash);
+        reader.read(entry.m_binary);
+        reader.read(entry.m_error);
+        if (entry.m_error.empty()) {
+            auto& info = entry.m_info;
+            uint8_t hookMode = 0;
+            uint32_t depCount = 0;
+            info.m_path = path;
+            reader.read(info.m_binaryName);
+            reader.read(info.m_version);
+            reader.read(info.m_id);
+            reader.read(info.m_name);
+            reader.read(info.m_developer);
+            reader.read(info.m_description);
+            reader.read(info.m_details);
+            reader.read(info.m_credits);
+            reader.read(hookMode);
+            reader.read(depCount);
+            info.m_hookMode = static_cast<HookMode>(hookMode);
+            for (uint32_t j = 0; j < depCount && reader.m_ok; j++) {
+                Dependency dep;
+                uint8_t required = 0;
+                reader.read(dep.m_id);
+                reader.read(dep.m_version);
+                reader.read(required);
+                dep.m_required = required;
+                info.m_dependencies.push_back(dep);
+            }
+        }
+        entries.insert({ path, entry });
+    }
+    // a partially written or corrupt index 
+    // is thrown out entirely
+    if (!reader.m_ok || reader.m_pos != data.size()) return;
+    this->m_entries = std::move(entries);
+}
+
+Result<> ModIndex::save() {
+    std::lock_guard lock(this->m_mutex);
+    for (auto it = this->m_entries.begin(); it != this->m_entries.end();) {
+        if (!it->second.m_seen) {
+            it = this->m_entries.erase(it);
+            this->m_dirty = true;
+        } else {
+            it++;
+        }
+    }
+    if (!this->m_dirty) {
+        return Ok<>();
+    }
+
+    index_writer writer;
+    writer.write(s_indexMagic);
+    writer.write(s_indexVersion);
+    writer.write(static_cast<int32_t>(Loader::s_supportedSchemaMin));
+    writer.write(static_cast<int32_t>(Loader::s_supportedSchemaMax));
+    writer.write(static_cast<uint32_t>(this->m_entries.size()));
+    for (auto const& [path, entry] : this->m_entries) {
+        writer.write(path);
+        writer.write(entry.m_size);
+        writer.write(entry.m_time);
+        writer.write(entry.m_hash);
+        writer.write(entry.m_binary);
+        writer.write(entry.m_error);
+        if (entry.m_error.empty()) {
+            auto const& info = entry.m_info;
+            writer.write(info.m_binaryName);
+            writer.write(info.m_version);
+            writer.write(info.m_id);
+            writer.write(info.m_name);
+            writer.write(info.m_developer);
+            writer.write(info.m_description);
+            writer.write(info.m_details);
+            writer.write(info.m_credits);
+            writer.write(static_cast<uint8_t>(info.m_hookMode));
+            writer.write(static_cast<uint32_t>(info.m_dependencies.size()));
+            for (auto const& dep : info.m_dependencies) {
+                writer.write(dep.m_id);
+                writer.write(dep.m_version);
+                writer.write(static_cast<uint8_t>(dep.m_required));
+            }
+        }
+    }
+
+    // write to a temporary file and swap it 
+    // in, so a crash mid-write never leaves 
+    // a corrupt index behind
+    auto path = ModIndex::getIndexPath();
+    auto temp = path;
+    temp += ".tmp";
+    auto wrt = file_utils::writeBinary(temp.string(), writer.m_data);
+    if (!wrt) {
+        return Err<>(wrt.error());
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        return Err<>("Unable to save mod index: " + ec.message());
+    }
+    this->m_dirty = false;
+    return Ok<>();
+}
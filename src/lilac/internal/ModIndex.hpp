@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Parsed metadata of every mod file seen 
+ * before, persisted to lilac/mods.index so 
+ * that on warm starts only mod files that 
+ * have changed are unzipped and parsed.
+ * 
+ * Entries are keyed on the file's path and 
+ * checked against its size & modification 
+ * time, which only takes a stat. If only 
+ * the time has changed, the archive's 
+ * central directory is hashed and compared 
+ * before giving up on the entry, so merely 
+ * touching or copying a mod doesn't make 
+ * it get parsed again. Mods whose mod.json 
+ * was read but rejected are remembered too, 
+ * along with why, so broken mods aren't 
+ * retried until they change; failures to 
+ * read the file at all are retried on 
+ * every launch.
+ * 
+ * Entries also remember which binary the 
+ * mod extracted into the binary cache the 
+ * last time it was loaded, so the binary is 
+ * kept while the mod is installed but not 
+ * loaded, i.e. waiting on a dependency. 
+ * 
+ * The whole index is thrown out when it 
+ * was written by a version of lilac that 
+ * parses mod.json differently, i.e. one 
+ * that supports other schemas or reads 
+ * other fields.
+ * @class ModIndex
+ */
+class ModIndex {
+    protected:
+        struct index_entry {
+            uint64_t m_size;
+            int64_t  m_time;
+            uint64_t m_hash;
+            /**
+             * BinaryCache hash of the mod's 
+             * binary, or 0 if it hasn't been 
+             * extracted since the file changed
+             */
+            uint64_t m_binary = 0;
+            bool     m_seen;
+            /**
+             * Why the file couldn't be read, or 
+             * empty if it could
+             */
+            std::string m_error;
+            ModInfo m_info;
+        };
+
+        static constexpr const uint32_t s_indexMagic = 0x584e494c; // LINX
+        /**
+         * Bump whenever the layout changes or 
+         * mod.json is parsed differently, e.g. a 
+         * new field is read from it
+         */
+        static constexpr const uint32_t s_indexVersion = 3;
+
+        std::unordered_map<std::string, index_entry> m_entries;
+        std::mutex m_mutex;
+        bool m_loaded = false;
+        bool m_dirty = false;
+
+        ModIndex() = default;
+
+        void load();
+
+    public:
+        static ModIndex* get();
+        static std::filesystem::path getIndexPath();
+
+        /**
+         * Get what reading a mod file resulted 
+         * in last time, if the file hasn't 
+         * changed since
+         * @param path Path to the mod file
+         * @returns The mod's info or why it 
+         * couldn't be read, or nothing if the 
+         * file has to be read again
+         */
+        std::optional<Result<ModInfo>> lookup(std::string const& path);
+
+        /**
+         * Remember what reading a mod file 
+         * resulted in. The size, time & hash of 
+         * the file are the ones it had when it 
+         * was opened for reading, so nothing is 
+         * stored if it isn't open in the 
+         * archive cache anymore, which is the 
+         * case if it couldn't be opened or 
+         * read at all
+         */
+        void store(std::string const& path, Result<ModInfo> const& info);
+
+        /**
+         * Remember which binary a mod file's 
+         * binary was extracted to, if the file 
+         * is indexed
+         * @param path Path to the mod file
+         * @param hash BinaryCache hash of the 
+         * binary
+         */
+        void setBinary(std::string const& path, uint64_t hash);
+
+        /**
+         * Get the binaries of every mod file 
+         * looked up or stored since the index 
+         * was loaded
+         * @returns BinaryCache hashes
+         */
+        std::unordered_set<uint64_t> getBinaries();
+
+        /**
+         * Write the index to disk if anything 
+         * has changed, dropping files that 
+         * haven't been looked up or stored 
+         * since it was loaded
+         */
+        Result<> save();
+};
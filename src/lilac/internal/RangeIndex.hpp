@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Index of address ranges, for finding every 
+ * range that overlaps a given one. Ranges are 
+ * kept sorted by start address alongside the 
+ * furthest end of any range up to and 
+ * including each one, so a query is a binary 
+ * search for the last range starting before 
+ * the end of the queried range, followed by a 
+ * walk back that stops as soon as no earlier 
+ * range can reach the queried one. For short 
+ * ranges such as patches & hooks that makes 
+ * queries O(log n + k) for k overlapping 
+ * ranges; inserting & erasing are O(n), 
+ * which is fine for ranges that are added 
+ * once and queried often.
+ * @class RangeIndex
+ */
+template <class T>
+class RangeIndex {
+    protected:
+        struct Range {
+            uintptr_t m_start;
+            uintptr_t m_end;
+            T m_value;
+        };
+
+        std::vector<Range> m_ranges;
+        /**
+         * Furthest end of ranges [0, i]
+         */
+        std::vector<uintptr_t> m_reach;
+
+        void updateReach(size_t from) {
+            this->m_reach.resize(this->m_ranges.size());
+            for (auto i = from; i < this->m_ranges.size(); i++) {
+                auto end = this->m_ranges[i].m_end;
+                this->m_reach[i] = i ? std::max(this->m_reach[i - 1], end) : end;
+            }
+        }
+
+    public:
+        void insert(uintptr_t start, size_t size, T value) {
+            auto pos = std::upper_bound(
+                this->m_ranges.begin(), this->m_ranges.end(), start,
+                [](uintptr_t start, Range const& range) { return start < range.m_start; }
+            );
+            auto ix = pos - this->m_ranges.begin();
+            this->m_ranges.insert(pos, Range { start, start + size, value });
+            this->updateReach(ix);
+        }
+
+        bool erase(uintptr_t start, T const& value) {
+            auto pos = std::lower_bound(
+                this->m_ranges.begin(), this->m_ranges.end(), start,
+                [](Range const& range, uintptr_t start) { return range.m_start < start; }
+            );
+            for (; pos != this->m_ranges.end() && pos->m_start == start; pos++) {
+                if (pos->m_value == value) {
+                    auto ix = pos - this->m_ranges.begin();
+                    this->m_ranges.erase(pos);
+                    this->updateReach(ix);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Get every value whose range overlaps 
+         * [start, start + size), in order of 
+         * address
+         */
+        std::vector<T> find(uintptr_t start, size_t size) const {
+            auto end = start + (size ? size : 1);
+            auto pos = std::lower_bound(
+                this->m_ranges.begin(), this->m_ranges.end(), end,
+                [](Range const& range, uintptr_t end) { return range.m_start < end; }
+            );
+            std::vector<T> res;
+            for (auto ix = pos - this->m_ranges.begin(); ix-- > 0;) {
+                if (this->m_reach[ix] <= start) break;
+                if (this->m_ranges[ix].m_end > start) {
+                    res.push_back(this->m_ranges[ix].m_value);
+                }
+            }
+            std::reverse(res.begin(), res.end());
+            return res;
+        }
+
+        /**
+         * Call `func(start, end, value)` for 
+         * every range in order of address
+         */
+        template <class Func>
+        void forEach(Func func) const {
+            for (auto const& range : this->m_ranges) {
+                func(range.m_start, range.m_end, range.m_value);
+            }
+        }
+
+        size_t size() const {
+            return this->m_ranges.size();
+        }
+};
@@ -0,0 +1,174 @@
+#include "SymbolResolver.hpp"
+#include <Loader.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+SymbolResolver* SymbolResolver::get() {
+    static auto g_resolver = new SymbolResolver;
+    return g_resolver;
+}
+
+std::filesystem::path SymbolResolver::getCachePath() {
+    return std::filesystem::path(lilac_directory) / "symbols.cache";
+}
+
+Result<SymbolResolver::module_info*> SymbolResolver::getModule(const char* name) {
+    // module names are case-insensitive on 
+    // windows, so normalize them
+    std::string key = name;
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) -> char {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+
+    auto known = this->m_modules.find(key);
+    if (known != this->m_modules.end()) {
+        return Ok<module_info*>(&known->second);
+    }
+
+    module_info info {};
+    if (!SymbolResolver::findModule(name, info)) {
+        return Err<>("Unable to find module \"" + std::string(name) + "\"");
+    }
+    info.m_nameHash = symbol_name::hash(key.c_str(), key.size());
+    return Ok<module_info*>(&this->m_modules.insert({ key, info }).first->second);
+}
+
+Result<uintptr_t> SymbolResolver::resolve(const char* module, symbol_name const& symbol) {
+    auto res = this->getModule(module);
+    if (!res) {
+        return Err<>(res.error());
+    }
+    auto info = res.value();
+
+    if (auto cached = this->lookup(module, symbol.m_hash)) {
+        return Ok<uintptr_t>(cached);
+    }
+
+    auto addr = SymbolResolver::findExport(*info, symbol.m_name);
+    if (!addr) {
+        return Err<>(
+            "Unable to find symbol \"" + std::string(symbol.m_name) + 
+            "\" in module \"" + std::string(module) + "\""
+        );
+    }
+    this->remember(module, symbol.m_hash, addr);
+    return Ok<uintptr_t>(addr);
+}
+
+uintptr_t SymbolResolver::lookup(const char* module, uint64_t key) {
+    if (!this->m_cacheLoaded) {
+        this->loadCache();
+    }
+    auto res = this->getModule(module);
+    if (!res) return 0;
+    auto info = res.value();
+
+    auto cached = this->m_cache.find({ info->m_nameHash, info->m_checksum, key });
+    if (cached != this->m_cache.end() && cached->second < info->m_size) {
+        return info->m_base + cached->second;
+    }
+    return 0;
+}
+
+void SymbolResolver::remember(const char* module, uint64_t key, uintptr_t address) {
+    auto res = this->getModule(module);
+    if (!res) return;
+    auto info = res.value();
+    if (address < info->m_base || address - info->m_base >= info->m_size) return;
+
+    this->m_cache[{ info->m_nameHash, info->m_checksum, key }] = 
+        static_cast<uint32_t>(address - info->m_base);
+    this->m_dirty = true;
+}
+
+Result<uintptr_t> SymbolResolver::getModuleBase(const char* module) {
+    auto res = this->getModule(module);
+    if (!res) {
+        return Err<>(res.error());
+    }
+    return Ok<uintptr_t>(res.value()->m_base);
+}
+
+Result<uint64_t> SymbolResolver::getModuleChecksum(const char* module) {
+    auto res = this->getModule(module);
+    if (!res) {
+        return Err<>(res.error());
+    }
+    return Ok<uint64_t>(res.value()->m_checksum);
+}
+
+// Cache file layout (little-endian):
+//   u32 magic, u32 version, u32 count
+//   count * { u64 module, u64 checksum, u64 symbol, u32 rva }
+
+static constexpr const size_t s_entrySize = 8 + 8 + 8 + 4;
+
+void SymbolResolver::loadCache() {
+    this->m_cacheLoaded = true;
+
+    auto read = file_utils::readBinary(SymbolResolver::getCachePath().string());
+    if (!read) return;
+    auto data = read.value();
+    if (data.size() < 12) return;
+
+    uint32_t header[3];
+    memcpy(header, data.data(), sizeof(header));
+    if (
+        header[0] != s_cacheMagic ||
+        header[1] != s_cacheVersion ||
+        data.size() != 12 + header[2] * s_entrySize
+    ) return;
+
+    auto entry = data.data() + 12;
+    for (uint32_t i = 0; i < header[2]; i++, entry += s_entrySize) {
+        cache_key key;
+        uint32_t rva;
+        memcpy(&key.m_module,   entry,      8);
+        memcpy(&key.m_checksum, entry + 8,  8);
+        memcpy(&key.m_symbol,   entry + 16, 8);
+        memcpy(&rva,            entry + 24, 4);
+        this->m_cache.insert({ key, rva });
+    }
+}
+
+Result<> SymbolResolver::saveCache() {
+    if (!this->m_dirty) {
+        return Ok<>();
+    }
+
+    byte_array data(12 + this->m_cache.size() * s_entrySize);
+    uint32_t header[3] = {
+        s_cacheMagic,
+        s_cacheVersion,
+        static_cast<uint32_t>(this->m_cache.size())
+    };
+    memcpy(data.data(), header, sizeof(header));
+    auto entry = data.data() + 12;
+    for (auto const& [key, rva] : this->m_cache) {
+        memcpy(entry,      &key.m_module,   8);
+        memcpy(entry + 8,  &key.m_checksum, 8);
+        memcpy(entry + 16, &key.m_symbol,   8);
+        memcpy(entry + 24, &rva,            4);
+        entry += s_entrySize;
+    }
+
+    // write to a temporary file and swap it 
+    // in, so a crash mid-write never leaves 
+    // a corrupt cache behind
+    auto path = SymbolResolver::getCachePath();
+    auto temp = path;
+    temp += ".tmp";
+    auto wrt = file_utils::writeBinary(temp.string(), data);
+    if (!wrt) {
+        return Err<>(wrt.error());
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        return Err<>("Unable to save symbol cache: " + ec.message());
+    }
+    this->m_dirty = false;
+    return Ok<>();
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Mod.hpp>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+USE_LILAC_NAMESPACE();
+
+/**
+ * Symbol name with its hash computed up 
+ * front. Implicitly constructible from 
+ * strings, and constexpr, so the hash of 
+ * a literal symbol in a constant 
+ * expression is folded at compile time.
+ */
+struct symbol_name {
+    const char* m_name;
+    uint64_t    m_hash;
+
+    static constexpr uint64_t hash(const char* str, size_t size) {
+        // FNV-1a
+        uint64_t res = 0xcbf29ce484222325;
+        for (size_t i = 0; i < size; i++) {
+            res ^= static_cast<uint8_t>(str[i]);
+            res *= 0x100000001b3;
+        }
+        return res;
+    }
+
+    static constexpr size_t length(const char* str) {
+        size_t size = 0;
+        while (str[size]) size++;
+        return size;
+    }
+
+    // a separate constructor for arrays would 
+    // never be picked over this one
+    constexpr symbol_name(const char* name)
+      : m_name(name), m_hash(hash(name, length(name))) {}
+};
+
+/**
+ * Process-wide symbol resolver.
+ * 
+ * Keeps one table of every module symbols 
+ * have been looked up in, and a cache of 
+ * (module, build checksum, symbol) -> RVA 
+ * that is persisted to disk, so that on 
+ * warm starts symbols are resolved without 
+ * walking any export tables. Cache entries 
+ * are tied to the checksum of the module 
+ * build they were resolved in, so updating 
+ * the game invalidates them automatically.
+ * @class SymbolResolver
+ */
+class SymbolResolver {
+    protected:
+        struct module_info {
+            void*     m_handle;
+            uintptr_t m_base;
+            size_t    m_size;
+            uint64_t  m_nameHash;
+            uint64_t  m_checksum;
+        };
+
+        struct cache_key {
+            uint64_t m_module;
+            uint64_t m_checksum;
+            uint64_t m_symbol;
+
+            bool operator==(cache_key const& other) const {
+                return
+                    m_module   == other.m_module &&
+                    m_checksum == other.m_checksum &&
+                    m_symbol   == other.m_symbol;
+            }
+        };
+
+        struct cache_key_hash {
+            size_t operator()(cache_key const& key) const {
+                return static_cast<size_t>(
+                    key.m_module ^ (key.m_checksum * 31) ^ (key.m_symbol * 131)
+                );
+            }
+        };
+
+        static constexpr const uint32_t s_cacheMagic = 0x4d59534c; // LSYM
+        static constexpr const uint32_t s_cacheVersion = 1;
+
+        std::unordered_map<std::string, module_info> m_modules;
+        std::unordered_map<cache_key, uint32_t, cache_key_hash> m_cache;
+        bool m_cacheLoaded = false;
+        bool m_dirty = false;
+
+        SymbolResolver() = default;
+
+        Result<module_info*> getModule(const char* name);
+        void loadCache();
+
+        // platform-specific
+        static bool findModule(const char* name, module_info& info);
+        static uintptr_t findExport(module_info const& info, const char* symbol);
+
+    public:
+        static SymbolResolver* get();
+
+        /**
+         * Get the absolute address of an 
+         * exported symbol
+         * @param module Name of the module, 
+         * i.e. "libcocos2d.dll"
+         * @param symbol Name of the symbol
+         * @returns Successful result containing 
+         * the address, errorful result with info 
+         * on error
+         */
+        Result<uintptr_t> resolve(const char* module, symbol_name const& symbol);
+
+        /**
+         * Look up a cached address by an arbitrary 
+         * key, i.e. a signature hash. Only returns 
+         * addresses cached for the module build 
+         * that is currently loaded.
+         * @returns The address, or 0 if there is 
+         * no cached address for the key
+         */
+        uintptr_t lookup(const char* module, uint64_t key);
+
+        /**
+         * Cache an address by an arbitrary key
+         */
+        void remember(const char* module, uint64_t key, uintptr_t address);
+
+        /**
+         * Get the base address of a module
+         */
+        Result<uintptr_t> getModuleBase(const char* module);
+
+        /**
+         * Get the build checksum of a module; 
+         * changes whenever the module binary 
+         * changes
+         */
+        Result<uint64_t> getModuleChecksum(const char* module);
+
+        /**
+         * Write the cache to disk if anything 
+         * new has been resolved since it was 
+         * loaded
+         */
+        Result<> saveCache();
+
+        static std::filesystem::path getCachePath();
+};
@@ -1,15 +1,18 @@
 #include <Loader.hpp>
 #include <Mod.hpp>
-#include <CApiMod.hpp>
-#include <InternalMod.hpp>
-#include <Log.hpp>
 #undef snprintf
 #include <json.hpp>
 #include <ZipUtils.h>
+#include <ArchiveCache.hpp>
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <thread>
+#include <unordered_map>
 
 USE_LILAC_NAMESPACE();
 
-template<> Result<Loader::MetaCheckResult> Loader::checkBySchema<1>(std::string const& path, void* jsonData);
+template<> Result<ModInfo> Loader::checkBySchema<1>(std::string const& path, void* jsonData);
 
 #define JSON_ASSIGN_IF_CONTAINS_AND_TYPE_FROM(_name_, _from_, _type_)\
     if (json.contains(#_from_) && !json[#_from_].is_null()) {   \
@@ -60,20 +63,26 @@ template<> Result<Loader::MetaCheckResult> Loader::checkBySchema<1>(std::string
         );                                                      \
     }
 
-Result<Loader::MetaCheckResult> Loader::checkMetaInformation(std::string const& path) {
-    // Unzip file
-    auto unzip = ZipFile::ZipFile(path);
-    if (!unzip.isLoaded()) {
-        return Err<>("\"" + path + "\": Unable to unzip");
+Result<ModInfo> Loader::readModInfo(std::string const& path) {
+    // Unzip file; the archive is kept open 
+    // for when the binary is extracted
+    auto open = ArchiveCache::get()->open(path);
+    if (!open) {
+        return Err<>(open.error());
     }
+    auto unzip = open.value();
     // Check if mod.json exists in zip
-    if (!unzip.fileExists("mod.json")) {
+    if (!unzip->fileExists("mod.json")) {
         return Err<>("\"" + path + "\" is missing mod.json");
     }
     // Read mod.json & parse if possible
     unsigned long readSize = 0;
-    auto read = unzip.getFileData("mod.json", &readSize);
+    auto read = unzip->getFileData("mod.json", &readSize);
     if (!read || !readSize) {
+        // may just be a bad read; closing the 
+        // archive keeps the error from being 
+        // remembered in the mod index
+        ArchiveCache::get()->release(path);
         return Err<>("\"" + path + "\": Unable to read mod.json");
     }
     nlohmann::json json;
@@ -115,7 +124,7 @@ Result<Loader::MetaCheckResult> Loader::checkMetaInformation(std::string const&
         
         // Handle mod.json data based on target
         switch (schema) {
-            case 1: return this->checkBySchema<1>(path, &json);
+            case 1: return Loader::checkBySchema<1>(path, &json);
         }
 
         // Target version was not handled
@@ -130,12 +139,13 @@ Result<Loader::MetaCheckResult> Loader::checkMetaInformation(std::string const&
     } catch(nlohmann::json::exception const& e) {
         return Err<>("\"" + path + "\": Unable to parse mod.json - \"" + e.what() + "\"");
     } catch(...) {
+        ArchiveCache::get()->release(path);
         return Err<>("\"" + path + "\": Unable to parse mod.json - Unknown Error");
     }
 }
 
 template<>
-Result<Loader::MetaCheckResult> Loader::checkBySchema<1>(std::string const& path, void* jsonData) {
+Result<ModInfo> Loader::checkBySchema<1>(std::string const& path, void* jsonData) {
     nlohmann::json json = *reinterpret_cast<nlohmann::json*>(jsonData);
     if (!json.contains("id")) {
         return Err<>("\"" + path + "\" lacks a Mod ID");
@@ -172,6 +182,22 @@ Result<Loader::MetaCheckResult> Loader::checkBySchema<1>(std::string const& path
     JSON_ASSIGN_IF_CONTAINS_AND_TYPE_FROM(binaryName, androidBinary, string);
     #endif
 
+    if (json.contains("hookMode") && json["hookMode"].is_string()) {
+        auto mode = json["hookMode"].get<std::string>();
+        if (mode == "trap") {
+            info.m_hookMode = HookMode::Trap;
+        } else if (mode == "inline") {
+            info.m_hookMode = HookMode::Inline;
+        } else if (mode == "import") {
+            info.m_hookMode = HookMode::Import;
+        } else {
+            return Err<>(
+                "\"" + path + "\": unknown hookMode \"" + mode + "\" "
+                "(should be \"trap\", \"inline\" or \"import\")"
+            );
+        }
+    }
+
     if (json.contains("dependencies")) {
         auto deps = json["dependencies"];
         if (deps.is_array()) {
@@ -185,19 +211,124 @@ Result<Loader::MetaCheckResult> Loader::checkBySchema<1>(std::string const& path
                     if (dep.contains("required")) {
                         depobj.m_required = dep["required"];
                     }
-                    depobj.m_loaded = this->getLoadedMod(depobj.m_id);
-                    depobj.m_unresolved = this->getUnresolvedMod(depobj.m_id);
                     info.m_dependencies.push_back(depobj);
                 }
             }
         }
     }
-    info.updateDependencyStates();
-    bool resolved = info.hasUnresolvedDependencies();
+    return Ok<ModInfo>(info);
+}
 
-    auto mod = new UnresolvedMod;
-    mod->m_info = info;
-    this->m_unresolvedMods.push_back(mod);
+std::vector<Result<ModInfo>> Loader::readModInfos(
+    std::vector<std::string> const& paths,
+    unsigned threads
+) {
+    if (!threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::max<size_t>(
+        1, std::min<size_t>(threads, paths.size())
+    ));
 
-    return Ok<MetaCheckResult>({ info.m_id, resolved });
+    // reading a mod is mostly waiting for the 
+    // disk & inflating, so mods are handed out 
+    // one at a time to whichever thread is 
+    // free instead of in fixed chunks
+    std::vector<Result<ModInfo>> res(paths.size(), Err<>("Not read"));
+    std::atomic_size_t next = 0;
+    auto work = [&]() {
+        for (auto i = next++; i < paths.size(); i = next++) {
+            res[i] = Loader::readModInfo(paths[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return res;
+}
+
+Loader::LoadPlan Loader::planLoadOrder(std::vector<ModInfo const*> const& mods) {
+    std::unordered_map<std::string, size_t> ids;
+    ids.reserve(mods.size());
+    for (size_t i = 0; i < mods.size(); i++) {
+        ids.insert({ mods[i]->m_id, i });
+    }
+
+    // edges only go between mods in the set; 
+    // dependencies outside of it are either 
+    // loaded already or missing, and neither 
+    // affects the order
+    std::vector<std::vector<size_t>> dependencies(mods.size());
+    std::vector<std::vector<size_t>> dependents(mods.size());
+    std::vector<size_t> waitingOn(mods.size(), 0);
+    for (size_t i = 0; i < mods.size(); i++) {
+        for (auto const& dep : mods[i]->m_dependencies) {
+            auto found = ids.find(dep.m_id);
+            if (found == ids.end()) continue;
+            dependencies[i].push_back(found->second);
+            dependents[found->second].push_back(i);
+            waitingOn[i]++;
+        }
+    }
+
+    // always take the first mod that isn't 
+    // waiting on anything, so the order only 
+    // depends on the order of `mods`
+    LoadPlan plan;
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+    for (size_t i = 0; i < mods.size(); i++) {
+        if (!waitingOn[i]) ready.push(i);
+    }
+    std::vector<bool> planned(mods.size(), false);
+    plan.order.reserve(mods.size());
+    while (ready.size()) {
+        auto next = ready.top();
+        ready.pop();
+        planned[next] = true;
+        plan.order.push_back(next);
+        for (auto const& dependent : dependents[next]) {
+            if (!--waitingOn[dependent]) {
+                ready.push(dependent);
+            }
+        }
+    }
+    if (plan.order.size() == mods.size()) {
+        return plan;
+    }
+
+    // every mod left over is waiting on another 
+    // mod left over, so following those edges 
+    // from any of them always ends up going 
+    // round a cycle. mods are only walked 
+    // through once, so each cycle is found once
+    enum class walk { None, OnPath, Done };
+    std::vector<walk> walked(mods.size(), walk::None);
+    for (size_t start = 0; start < mods.size(); start++) {
+        if (planned[start] || walked[start] != walk::None) continue;
+        std::vector<size_t> path;
+        auto at = start;
+        while (walked[at] == walk::None) {
+            walked[at] = walk::OnPath;
+            path.push_back(at);
+            for (auto const& dep : dependencies[at]) {
+                if (!planned[dep]) {
+                    at = dep;
+                    break;
+                }
+            }
+        }
+        if (walked[at] == walk::OnPath) {
+            auto cycle = std::find(path.begin(), path.end(), at);
+            plan.cycles.push_back(std::vector<size_t>(cycle, path.end()));
+        }
+        for (auto const& ix : path) {
+            walked[ix] = walk::Done;
+        }
+    }
+    return plan;
 }
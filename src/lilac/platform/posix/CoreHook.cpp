@@ -0,0 +1,224 @@
+#include <Memory.hpp>
+
+#if !defined(LILAC_IS_WINDOWS) && !defined(LILAC_IS_MACOS)
+
+#include <core/hook/hook.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <signal.h>
+#include <sys/uio.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+// Trap hooks for POSIX: the first byte of the 
+// hooked function is replaced with an int3, 
+// and the SIGTRAP it raises is handled by 
+// moving the thread over to the detour. 
+// Traps that aren't ours are passed on to 
+// whatever handler was there before, so 
+// when debugging, tell the debugger to pass 
+// SIGTRAP through (in gdb: `handle SIGTRAP 
+// nostop noprint pass`). 
+// 
+// The handler never steps over a trap, so 
+// calling the hooked function from its own 
+// detour would trap again forever. HookChain 
+// calls the relocated prologue instead, and 
+// refuses to trap functions it can't 
+// relocate.
+
+#if defined(__x86_64__)
+    #define LILAC_TRAP_PC REG_RIP
+#elif defined(__i386__)
+    #define LILAC_TRAP_PC REG_EIP
+#else
+    #error "Trap hooks are not implemented for this architecture"
+#endif
+
+static constexpr const uint8_t s_trap = 0xCC;
+
+struct trap_hook {
+    void*   m_address;
+    uint8_t m_original;
+};
+
+// The signal handler can't take locks or 
+// allocate, so traps live in a fixed-size 
+// open-addressed table that is written to 
+// under g_trapLock and read without it. An 
+// address keeps its slot forever; removing 
+// a trap just clears the detour, so there 
+// are no tombstones and no slot is ever 
+// reused for another address.
+struct trap_slot {
+    std::atomic<uintptr_t> m_address;
+    std::atomic<uintptr_t> m_detour;
+};
+
+static constexpr const size_t s_trapBits = 14;
+static constexpr const size_t s_trapCapacity = static_cast<size_t>(1) << s_trapBits;
+
+static trap_slot g_traps[s_trapCapacity];
+static std::mutex g_trapLock;
+static struct sigaction g_previousHandler;
+static bool g_handlerInstalled = false;
+
+static size_t trapIndex(uintptr_t address) {
+    return static_cast<size_t>(
+        (static_cast<uint64_t>(address) * 0x9E3779B97F4A7C15ull) >> (64 - s_trapBits)
+    );
+}
+
+static trap_slot* findTrap(uintptr_t address) {
+    auto ix = trapIndex(address);
+    for (size_t i = 0; i < s_trapCapacity; i++) {
+        auto& slot = g_traps[(ix + i) & (s_trapCapacity - 1)];
+        auto at = slot.m_address.load(std::memory_order_acquire);
+        if (at == address) return &slot;
+        if (!at) return nullptr;
+    }
+    return nullptr;
+}
+
+// only called with g_trapLock held
+static trap_slot* claimTrap(uintptr_t address) {
+    auto ix = trapIndex(address);
+    for (size_t i = 0; i < s_trapCapacity; i++) {
+        auto& slot = g_traps[(ix + i) & (s_trapCapacity - 1)];
+        auto at = slot.m_address.load(std::memory_order_relaxed);
+        if (at == address) return &slot;
+        if (!at) {
+            slot.m_address.store(address, std::memory_order_release);
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+static void forwardSignal(int sig, siginfo_t* info, void* context) {
+    if (g_previousHandler.sa_flags & SA_SIGINFO) {
+        if (g_previousHandler.sa_sigaction) {
+            g_previousHandler.sa_sigaction(sig, info, context);
+        }
+        return;
+    }
+    if (g_previousHandler.sa_handler == SIG_IGN) {
+        return;
+    }
+    if (g_previousHandler.sa_handler == SIG_DFL) {
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+    g_previousHandler.sa_handler(sig);
+}
+
+static void onTrap(int sig, siginfo_t* info, void* context) {
+    auto uc = static_cast<ucontext_t*>(context);
+    auto& pc = uc->uc_mcontext.gregs[LILAC_TRAP_PC];
+    // the int3 has already executed
+    auto address = static_cast<uintptr_t>(pc) - 1;
+
+    auto slot = findTrap(address);
+    if (!slot) {
+        return forwardSignal(sig, info, context);
+    }
+    auto detour = slot->m_detour.load(std::memory_order_acquire);
+    if (detour) {
+        pc = static_cast<greg_t>(detour);
+    } else {
+        // the trap was removed after this thread 
+        // hit it; the original byte is already 
+        // back, so just run it
+        pc = static_cast<greg_t>(address);
+    }
+}
+
+// only called with g_trapLock held
+static bool installHandler() {
+    if (g_handlerInstalled) return true;
+
+    struct sigaction action = {};
+    action.sa_sigaction = &onTrap;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGTRAP, &action, &g_previousHandler)) {
+        return false;
+    }
+    g_handlerInstalled = true;
+    return true;
+}
+
+namespace lilac::core::hook {
+    const void* add(const void* address, const void* detour) {
+        std::lock_guard<std::mutex> lock(g_trapLock);
+        if (!installHandler()) {
+            return nullptr;
+        }
+        auto hook = new trap_hook { const_cast<void*>(address) };
+        if (!read_memory(hook->m_address, &hook->m_original, 1)) {
+            delete hook;
+            return nullptr;
+        }
+        auto slot = claimTrap(as<uintptr_t>(address));
+        if (!slot || slot->m_detour.load(std::memory_order_relaxed)) {
+            delete hook;
+            return nullptr;
+        }
+        // the detour has to be in place before 
+        // any thread can hit the trap
+        slot->m_detour.store(as<uintptr_t>(detour), std::memory_order_release);
+        if (!write_memory(hook->m_address, &s_trap, 1)) {
+            slot->m_detour.store(0, std::memory_order_release);
+            delete hook;
+            return nullptr;
+        }
+        return hook;
+    }
+
+    bool remove(const void* handle) {
+        std::lock_guard<std::mutex> lock(g_trapLock);
+        auto hook = as<trap_hook*>(const_cast<void*>(handle));
+        auto slot = findTrap(as<uintptr_t>(hook->m_address));
+        if (!slot) {
+            return false;
+        }
+        // and the original byte has to be back 
+        // before the detour is cleared, so that 
+        // a thread that sees no detour can just 
+        // run the function
+        if (!write_memory(hook->m_address, &hook->m_original, 1)) {
+            return false;
+        }
+        slot->m_detour.store(0, std::memory_order_release);
+        delete hook;
+        return true;
+    }
+
+    bool write_memory(void* to, const void* from, size_t size) {
+        PageUnprotect pages;
+        if (!pages.add(to, size)) {
+            return false;
+        }
+        memcpy(to, from, size);
+        return true;
+    }
+
+    bool read_memory(void* from, void* to, size_t size) {
+        // unlike memcpy, this fails gracefully 
+        // if the memory isn't mapped
+        iovec local { to, size };
+        iovec remote { from, size };
+        auto read = process_vm_readv(getpid(), &local, 1, &remote, 1, 0);
+        if (read < 0 && (errno == ENOSYS || errno == EPERM)) {
+            // not allowed in some sandboxes
+            memcpy(to, from, size);
+            return true;
+        }
+        return read == static_cast<ssize_t>(size);
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include <ImportHook.hpp>
+
+#ifndef LILAC_IS_WINDOWS
+
+#ifdef LILAC_IS_MACOS
+
+// lazy & non-lazy symbol pointers of 
+// Mach-O images are not handled yet
+void ImportHook::findSlots(void* function, std::vector<void**>& slots) {}
+
+#else
+
+#include <dlfcn.h>
+#include <link.h>
+#include <cstring>
+
+#if defined(__x86_64__)
+    using elf_reloc = ElfW(Rela);
+    static constexpr const auto s_relocTag     = DT_RELA;
+    static constexpr const auto s_relocSizeTag = DT_RELASZ;
+    static constexpr const auto s_jumpSlot     = R_X86_64_JUMP_SLOT;
+    static constexpr const auto s_globDat      = R_X86_64_GLOB_DAT;
+    #define LILAC_R_SYM(_info_)  ELF64_R_SYM(_info_)
+    #define LILAC_R_TYPE(_info_) ELF64_R_TYPE(_info_)
+#elif defined(__i386__)
+    using elf_reloc = ElfW(Rel);
+    static constexpr const auto s_relocTag     = DT_REL;
+    static constexpr const auto s_relocSizeTag = DT_RELSZ;
+    static constexpr const auto s_jumpSlot     = R_386_JMP_SLOT;
+    static constexpr const auto s_globDat      = R_386_GLOB_DAT;
+    #define LILAC_R_SYM(_info_)  ELF32_R_SYM(_info_)
+    #define LILAC_R_TYPE(_info_) ELF32_R_TYPE(_info_)
+#else
+    #error "ImportHook is not implemented for this architecture"
+#endif
+
+struct slot_search {
+    void* m_function;
+    // name of the function, for finding 
+    // slots that haven't been bound yet
+    const char* m_name;
+    std::vector<void**>* m_slots;
+};
+
+// glibc relocates the pointers in the 
+// dynamic section at load, others don't
+static uintptr_t dynamicPointer(uintptr_t base, uintptr_t ptr) {
+    return ptr < base ? base + ptr : ptr;
+}
+
+static void searchRelocs(
+    uintptr_t base,
+    elf_reloc const* relocs, size_t size,
+    ElfW(Sym) const* symtab, const char* strtab,
+    slot_search& search
+) {
+    if (!relocs) return;
+    for (size_t i = 0; i < size / sizeof(elf_reloc); i++) {
+        auto const& reloc = relocs[i];
+        auto type = LILAC_R_TYPE(reloc.r_info);
+        // GLOB_DAT slots are what calls go 
+        // through with -fno-plt
+        if (type != s_jumpSlot && type != s_globDat) continue;
+
+        auto slot = as<void**>(base + reloc.r_offset);
+        if (*slot == search.m_function) {
+            search.m_slots->push_back(slot);
+            continue;
+        }
+        // a lazily bound slot still points into 
+        // the PLT until its first call
+        if (type != s_jumpSlot || !search.m_name || !symtab || !strtab) continue;
+        auto name = strtab + symtab[LILAC_R_SYM(reloc.r_info)].st_name;
+        if (!strcmp(name, search.m_name)) {
+            search.m_slots->push_back(slot);
+        }
+    }
+}
+
+static int searchModule(dl_phdr_info* info, size_t, void* data) {
+    auto& search = *as<slot_search*>(data);
+    auto base = static_cast<uintptr_t>(info->dlpi_addr);
+
+    ElfW(Dyn) const* dyn = nullptr;
+    for (size_t i = 0; i < info->dlpi_phnum; i++) {
+        if (info->dlpi_phdr[i].p_type == PT_DYNAMIC) {
+            dyn = as<ElfW(Dyn) const*>(base + info->dlpi_phdr[i].p_vaddr);
+            break;
+        }
+    }
+    if (!dyn) return 0;
+
+    ElfW(Sym) const* symtab = nullptr;
+    const char* strtab = nullptr;
+    elf_reloc const* plt = nullptr;
+    elf_reloc const* relocs = nullptr;
+    size_t pltSize = 0;
+    size_t relocsSize = 0;
+    for (; dyn->d_tag != DT_NULL; dyn++) {
+        auto ptr = dynamicPointer(base, dyn->d_un.d_ptr);
+        switch (dyn->d_tag) {
+            case DT_SYMTAB:     symtab = as<ElfW(Sym) const*>(ptr); break;
+            case DT_STRTAB:     strtab = as<const char*>(ptr); break;
+            case DT_JMPREL:     plt = as<elf_reloc const*>(ptr); break;
+            case DT_PLTRELSZ:   pltSize = dyn->d_un.d_val; break;
+            case s_relocTag:    relocs = as<elf_reloc const*>(ptr); break;
+            case s_relocSizeTag: relocsSize = dyn->d_un.d_val; break;
+        }
+    }
+    searchRelocs(base, plt, pltSize, symtab, strtab, search);
+    searchRelocs(base, relocs, relocsSize, symtab, strtab, search);
+    return 0;
+}
+
+void ImportHook::findSlots(void* function, std::vector<void**>& slots) {
+    slot_search search { function, nullptr, &slots };
+    // only match unbound slots by name if the 
+    // name would actually bind to this function
+    Dl_info info;
+    if (
+        dladdr(function, &info) && info.dli_sname &&
+        info.dli_saddr == function &&
+        dlsym(RTLD_DEFAULT, info.dli_sname) == function
+    ) {
+        search.m_name = info.dli_sname;
+    }
+    dl_iterate_phdr(&searchModule, &search);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+#include <Memory.hpp>
+
+#ifndef LILAC_IS_WINDOWS
+
+#include <cstdio>
+#include <sys/mman.h>
+#include <unistd.h>
+
+size_t PageUnprotect::pageSize() {
+    static auto g_pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return g_pageSize;
+}
+
+// mprotect can't tell what the protection 
+// was, so look the page up in the maps
+static int currentProtection(uintptr_t page) {
+    // code is readable & executable if 
+    // it can't be found for some reason
+    int prot = PROT_READ | PROT_EXEC;
+    auto maps = fopen("/proc/self/maps", "r");
+    if (!maps) return prot;
+
+    char line[512];
+    while (fgets(line, sizeof(line), maps)) {
+        unsigned long start, end;
+        char perms[5];
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) != 3) continue;
+        if (page < start || page >= end) continue;
+        prot = PROT_NONE;
+        if (perms[0] == 'r') prot |= PROT_READ;
+        if (perms[1] == 'w') prot |= PROT_WRITE;
+        if (perms[2] == 'x') prot |= PROT_EXEC;
+        break;
+    }
+    fclose(maps);
+    return prot;
+}
+
+bool PageUnprotect::unprotectPage(Page& page) {
+    auto old = currentProtection(page.m_address);
+    if (mprotect(
+        as<void*>(page.m_address),
+        PageUnprotect::pageSize(),
+        PROT_READ | PROT_WRITE | PROT_EXEC
+    )) {
+        return false;
+    }
+    page.m_oldProtection = static_cast<uint32_t>(old);
+    return true;
+}
+
+void PageUnprotect::restorePage(Page const& page) {
+    mprotect(
+        as<void*>(page.m_address),
+        PageUnprotect::pageSize(),
+        static_cast<int>(page.m_oldProtection)
+    );
+    ExecutableMemory::flush(as<void*>(page.m_address), PageUnprotect::pageSize());
+}
+
+static void* mapPages(void* hint, size_t size) {
+    #ifdef MAP_FIXED_NOREPLACE
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS | (hint ? MAP_FIXED_NOREPLACE : 0);
+    #else
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    #endif
+    auto res = mmap(hint, size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+    return res == MAP_FAILED ? nullptr : res;
+}
+
+void* ExecutableMemory::reservePages(void* near, size_t size) {
+    if (!near) {
+        return mapPages(nullptr, size);
+    }
+
+    // mmap only takes the address as a hint, 
+    // so try addresses outwards from the 
+    // target in both directions and keep the 
+    // first mapping that actually lands in 
+    // range. large steps keep the amount of 
+    // attempts low; the whole point is 
+    // landing anywhere in range, not close
+    static constexpr const uintptr_t s_step = 0x1000000;
+    auto target = as<uintptr_t>(near) - as<uintptr_t>(near) % s_slabSize;
+    for (uintptr_t distance = s_step; distance + size < s_maxDistance; distance += s_step) {
+        for (auto up : { true, false }) {
+            if (!up && distance >= target) continue;
+
+            auto hint = up ? target + distance : target - distance;
+            auto res = mapPages(as<void*>(hint), size);
+            if (!res) continue;
+            if (ExecutableMemory::isNear(res, size, near)) {
+                return res;
+            }
+            munmap(res, size);
+        }
+    }
+    return nullptr;
+}
+
+void ExecutableMemory::releasePages(void* pages, size_t size) {
+    munmap(pages, size);
+}
+
+void ExecutableMemory::flush(void* memory, size_t size) {
+    __builtin___clear_cache(as<char*>(memory), as<char*>(memory) + size);
+}
+
+#endif
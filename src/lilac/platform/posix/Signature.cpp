@@ -0,0 +1,48 @@
+#include <Signature.hpp>
+#include <utils/casts.hpp>
+
+#ifndef LILAC_IS_WINDOWS
+
+#include <dlfcn.h>
+#include <link.h>
+
+USE_LILAC_NAMESPACE();
+
+struct phdr_search {
+    uintptr_t m_base;
+    std::vector<std::pair<const uint8_t*, size_t>> m_ranges;
+};
+
+std::vector<std::pair<const uint8_t*, size_t>> SignatureScanner::getExecutableRanges(
+    const char* module
+) {
+    auto handle = dlopen(module, RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) return {};
+
+    link_map* map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) || !map) {
+        dlclose(handle);
+        return {};
+    }
+
+    phdr_search search { static_cast<uintptr_t>(map->l_addr) };
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) -> int {
+        auto search = as<phdr_search*>(data);
+        if (info->dlpi_addr != search->m_base) return 0;
+        for (size_t i = 0; i < info->dlpi_phnum; i++) {
+            auto const& seg = info->dlpi_phdr[i];
+            if (seg.p_type == PT_LOAD && (seg.p_flags & PF_X)) {
+                search->m_ranges.push_back({
+                    as<const uint8_t*>(info->dlpi_addr + seg.p_vaddr),
+                    seg.p_memsz
+                });
+            }
+        }
+        return 1;
+    }, &search);
+
+    dlclose(handle);
+    return search.m_ranges;
+}
+
+#endif
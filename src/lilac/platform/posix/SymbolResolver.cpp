@@ -0,0 +1,58 @@
+#include <SymbolResolver.hpp>
+
+#ifndef LILAC_IS_WINDOWS
+
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+bool SymbolResolver::findModule(const char* name, module_info& info) {
+    // RTLD_NOLOAD: only look at modules that 
+    // are already loaded, like GetModuleHandle
+    auto handle = dlopen(name, RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) return false;
+
+    link_map* map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) || !map) {
+        dlclose(handle);
+        return false;
+    }
+    info.m_handle = handle;
+    info.m_base = static_cast<uintptr_t>(map->l_addr);
+
+    // the image size is the end of the 
+    // furthest loadable segment
+    info.m_size = 0;
+    dl_iterate_phdr([](dl_phdr_info* phdr, size_t, void* data) -> int {
+        auto info = as<module_info*>(data);
+        if (phdr->dlpi_addr != info->m_base) return 0;
+        for (size_t i = 0; i < phdr->dlpi_phnum; i++) {
+            auto const& seg = phdr->dlpi_phdr[i];
+            if (seg.p_type == PT_LOAD) {
+                info->m_size = std::max<size_t>(info->m_size, seg.p_vaddr + seg.p_memsz);
+            }
+        }
+        return 1;
+    }, &info);
+
+    // ELF has no checksum in its header, so 
+    // identify the build by the file's size 
+    // & modification time
+    struct stat st;
+    auto path = map->l_name && *map->l_name ? map->l_name : "/proc/self/exe";
+    if (stat(path, &st)) {
+        dlclose(handle);
+        return false;
+    }
+    info.m_checksum = 
+        (static_cast<uint64_t>(st.st_mtime) << 32) ^
+        static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+uintptr_t SymbolResolver::findExport(module_info const& info, const char* symbol) {
+    return as<uintptr_t>(dlsym(info.m_handle, symbol));
+}
+
+#endif
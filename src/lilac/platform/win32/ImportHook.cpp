@@ -0,0 +1,42 @@
+#include <ImportHook.hpp>
+
+#ifdef LILAC_IS_WINDOWS
+
+#include <Windows.h>
+#include <TlHelp32.h>
+
+static void findSlotsIn(uintptr_t base, void* function, std::vector<void**>& slots) {
+    auto dos = as<IMAGE_DOS_HEADER*>(base);
+    auto nt = as<IMAGE_NT_HEADERS*>(base + dos->e_lfanew);
+    auto const& dir = nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+    if (!dir.VirtualAddress || !dir.Size) return;
+
+    auto desc = as<IMAGE_IMPORT_DESCRIPTOR*>(base + dir.VirtualAddress);
+    for (; desc->Name; desc++) {
+        // FirstThunk is the bound IAT; it holds 
+        // the resolved addresses once the 
+        // module is loaded
+        auto thunk = as<IMAGE_THUNK_DATA*>(base + desc->FirstThunk);
+        for (; thunk->u1.Function; thunk++) {
+            if (as<void*>(thunk->u1.Function) == function) {
+                slots.push_back(as<void**>(&thunk->u1.Function));
+            }
+        }
+    }
+}
+
+void ImportHook::findSlots(void* function, std::vector<void**>& slots) {
+    auto snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, GetCurrentProcessId());
+    if (snapshot == INVALID_HANDLE_VALUE) return;
+
+    MODULEENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    if (Module32First(snapshot, &entry)) {
+        do {
+            findSlotsIn(as<uintptr_t>(entry.modBaseAddr), function, slots);
+        } while (Module32Next(snapshot, &entry));
+    }
+    CloseHandle(snapshot);
+}
+
+#endif
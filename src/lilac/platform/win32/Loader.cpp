@@ -6,6 +6,10 @@
 #include <InternalMod.hpp>
 #include <Log.hpp>
 #include <ZipUtils.h>
+#include <ArchiveCache.hpp>
+#include <BinaryCache.hpp>
+#include <ModIndex.hpp>
+#include <algorithm>
 
 #ifdef LILAC_IS_WINDOWS
 
@@ -46,53 +50,58 @@ Mod* loadWithCApi(HMODULE load) {
 }
 
 Result<Mod*> Loader::loadResolvedMod(std::string const& id) {
-    auto ix = this->m_unresolvedMods.begin();
-    ModInfo info;
-    for (auto const& mod : this->m_unresolvedMods) {
-        if (mod->m_info.m_id == id) {
-            info = mod->m_info;
-        } else { ix++; }
-    }
+    auto ix = std::find_if(
+        this->m_unresolvedMods.begin(),
+        this->m_unresolvedMods.end(),
+        [id](UnresolvedMod* mod) -> bool {
+            return mod->m_info.m_id == id;
+        }
+    );
     if (ix == this->m_unresolvedMods.end()) {
         return Err<>("Mod with the ID of " + id + " has not been loaded");
     }
+    auto info = (*ix)->m_info;
     this->m_unresolvedMods.erase(ix);
 
-    auto unzip = ZipFile::ZipFile(info.m_path);
-
-    if (!unzip.isLoaded()) {
-        return Err<>("Unable to re-read zip for \"" + id + "\"");
+    // usually still open from reading mod.json
+    auto open = ArchiveCache::get()->open(info.m_path);
+    if (!open) {
+        return Err<>("Unable to re-read zip for \"" + id + "\": " + open.error());
     }
+    auto unzip = open.value();
 
-    if (!unzip.fileExists(info.m_binaryName)) {
+    if (!unzip->fileExists(info.m_binaryName)) {
         return Err<>(
             "Unable to find platform binary under the name \"" +
             info.m_binaryName + "\" in \"" + id + "\""
         );
     }
 
-    auto tempDir = const_join_path_c_str<lilac_directory, lilac_temp_directory>;
+    auto tempDir = BinaryCache::getDirectory();
     if (!std::filesystem::exists(tempDir)) {
-        auto dir = file_utils::createDirectory(tempDir);
+        auto dir = file_utils::createDirectory(tempDir.string());
         if (!dir) return Err<>(dir.error());
     }
     
     unsigned long size;
-    auto data = unzip.getFileData(info.m_binaryName, &size);
+    auto data = unzip->getFileData(info.m_binaryName, &size);
+    // nothing else is needed from the archive
+    ArchiveCache::get()->release(info.m_path);
     if (!data || !size) {
         return Err<>("Unable to read \"" + info.m_binaryName + "\" for \"" + id + "\"");
     }
     
-    static long long g_tempID = 0;
-
-    auto tempPath = 
-        std::filesystem::path(lilac_directory) / 
-        lilac_temp_directory / 
-        ("mod_" + std::to_string(g_tempID++) + ".dll");
-    auto wrt = file_utils::writeBinary(tempPath, byte_array(data, data + size));
-    if (!wrt) return Err<>(wrt.error());
-
-    auto load = LoadLibraryA(tempPath.string().c_str());
+    // only written out if this build of the 
+    // binary hasn't been extracted before
+    auto hash = BinaryCache::hash(data, size);
+    auto extract = BinaryCache::get()->extract(data, size, hash);
+    delete[] data;
+    if (!extract) return Err<>(extract.error());
+    // kept even on launches where the mod 
+    // doesn't get loaded
+    ModIndex::get()->setBinary(info.m_path, hash);
+
+    auto load = LoadLibraryA(extract.value().string().c_str());
     if (load) {
         Mod* mod = nullptr;
 
@@ -110,7 +119,10 @@ Result<Mod*> Loader::loadResolvedMod(std::string const& id) {
             mod->m_info = info;
             this->m_mods.push_back(mod);
             for (auto const& dep : mod->m_info.m_dependencies) {
-                dep.m_loaded->m_parentDependencies.push_back(mod);
+                // optional dependencies may be missing
+                if (dep.m_loaded) {
+                    dep.m_loaded->m_parentDependencies.push_back(mod);
+                }
             }
             return Ok<Mod*>(mod);
         } else {
@@ -0,0 +1,108 @@
+#include <Memory.hpp>
+
+#ifdef LILAC_IS_WINDOWS
+
+#include <Windows.h>
+
+size_t PageUnprotect::pageSize() {
+    static auto g_pageSize = []() -> size_t {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }();
+    return g_pageSize;
+}
+
+bool PageUnprotect::unprotectPage(Page& page) {
+    DWORD old;
+    if (!VirtualProtect(
+        as<LPVOID>(page.m_address),
+        PageUnprotect::pageSize(),
+        PAGE_EXECUTE_READWRITE,
+        &old
+    )) {
+        return false;
+    }
+    page.m_oldProtection = old;
+    return true;
+}
+
+void PageUnprotect::restorePage(Page const& page) {
+    DWORD old;
+    VirtualProtect(
+        as<LPVOID>(page.m_address),
+        PageUnprotect::pageSize(),
+        page.m_oldProtection,
+        &old
+    );
+    FlushInstructionCache(
+        GetCurrentProcess(),
+        as<LPCVOID>(page.m_address),
+        PageUnprotect::pageSize()
+    );
+}
+
+static uintptr_t roundDown(uintptr_t address, size_t alignment) {
+    return address - address % alignment;
+}
+
+static size_t allocationGranularity() {
+    static auto g_granularity = []() -> size_t {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+    }();
+    return g_granularity;
+}
+
+void* ExecutableMemory::reservePages(void* near, size_t size) {
+    if (!near) {
+        return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    }
+
+    auto granularity = allocationGranularity();
+    auto target = as<uintptr_t>(near);
+    auto min = target > s_maxDistance ? target - s_maxDistance : granularity;
+    auto max = target < UINTPTR_MAX - s_maxDistance ? target + s_maxDistance : UINTPTR_MAX;
+
+    // walk the free regions outwards from the 
+    // target, first upwards and then downwards, 
+    // and take the first one that fits
+    MEMORY_BASIC_INFORMATION info;
+    auto addr = roundDown(target, granularity) + granularity;
+    while (addr + size < max && VirtualQuery(as<LPCVOID>(addr), &info, sizeof info)) {
+        auto regionEnd = as<uintptr_t>(info.BaseAddress) + info.RegionSize;
+        if (info.State == MEM_FREE && regionEnd - addr >= size) {
+            auto res = VirtualAlloc(
+                as<LPVOID>(addr), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE
+            );
+            if (res) return res;
+        }
+        addr = roundDown(regionEnd + granularity - 1, granularity);
+    }
+
+    addr = roundDown(target - size, granularity);
+    while (addr > min && VirtualQuery(as<LPCVOID>(addr), &info, sizeof info)) {
+        auto regionStart = as<uintptr_t>(info.BaseAddress);
+        auto regionEnd = regionStart + info.RegionSize;
+        if (info.State == MEM_FREE && regionEnd - addr >= size) {
+            auto res = VirtualAlloc(
+                as<LPVOID>(addr), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE
+            );
+            if (res) return res;
+        }
+        if (regionStart < min + size) break;
+        addr = roundDown(regionStart - size, granularity);
+    }
+    return nullptr;
+}
+
+void ExecutableMemory::releasePages(void* pages, size_t) {
+    VirtualFree(pages, 0, MEM_RELEASE);
+}
+
+void ExecutableMemory::flush(void* memory, size_t size) {
+    FlushInstructionCache(GetCurrentProcess(), memory, size);
+}
+
+#endif
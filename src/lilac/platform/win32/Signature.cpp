@@ -0,0 +1,32 @@
+#include <Signature.hpp>
+#include <utils/casts.hpp>
+
+#ifdef LILAC_IS_WINDOWS
+
+#include <Windows.h>
+
+USE_LILAC_NAMESPACE();
+
+std::vector<std::pair<const uint8_t*, size_t>> SignatureScanner::getExecutableRanges(
+    const char* module
+) {
+    std::vector<std::pair<const uint8_t*, size_t>> res;
+
+    auto base = as<uintptr_t>(GetModuleHandleA(module));
+    if (!base) return res;
+
+    auto dos = as<IMAGE_DOS_HEADER*>(base);
+    auto nt = as<IMAGE_NT_HEADERS*>(base + dos->e_lfanew);
+    auto section = IMAGE_FIRST_SECTION(nt);
+    for (WORD i = 0; i < nt->FileHeader.NumberOfSections; i++, section++) {
+        if (section->Characteristics & IMAGE_SCN_MEM_EXECUTE) {
+            res.push_back({
+                as<const uint8_t*>(base + section->VirtualAddress),
+                section->Misc.VirtualSize
+            });
+        }
+    }
+    return res;
+}
+
+#endif
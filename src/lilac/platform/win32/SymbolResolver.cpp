@@ -0,0 +1,35 @@
+#include <SymbolResolver.hpp>
+
+#ifdef LILAC_IS_WINDOWS
+
+#include <Windows.h>
+
+static IMAGE_NT_HEADERS* ntHeaders(uintptr_t base) {
+    auto dos = as<IMAGE_DOS_HEADER*>(base);
+    return as<IMAGE_NT_HEADERS*>(base + dos->e_lfanew);
+}
+
+bool SymbolResolver::findModule(const char* name, module_info& info) {
+    auto hmod = GetModuleHandleA(name);
+    if (!hmod) return false;
+
+    info.m_handle = hmod;
+    info.m_base = as<uintptr_t>(hmod);
+
+    // the linker timestamp, PE checksum and 
+    // image size together identify a build 
+    // well enough without hashing the file
+    auto nt = ntHeaders(info.m_base);
+    info.m_size = nt->OptionalHeader.SizeOfImage;
+    info.m_checksum = 
+        (static_cast<uint64_t>(nt->FileHeader.TimeDateStamp) << 32) ^
+        (static_cast<uint64_t>(nt->OptionalHeader.CheckSum) << 16) ^
+        nt->OptionalHeader.SizeOfImage;
+    return true;
+}
+
+uintptr_t SymbolResolver::findExport(module_info const& info, const char* symbol) {
+    return as<uintptr_t>(GetProcAddress(as<HMODULE>(info.m_handle), symbol));
+}
+
+#endif
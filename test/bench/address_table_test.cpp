@@ -0,0 +1,223 @@
+// Checks the generated address tables against the bindings they 
+// were generated from (address_table_test.bindings, read at 
+// runtime): fake PE headers with the timestamp, checksum & size 
+// of each build select that build's table, anything else falls 
+// back to the default table, every binding is found in its table 
+// with the right offset, functions that aren't bound aren't 
+// found, and addresses are offsets from the image's base.
+//
+// usage: lilac_address_table_test
+
+#include "AddressTable.hpp"
+#include "AddressTable.gen.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// looked up at compile time
+static_assert(
+    AddressTable::find(g_addressTables[0], "EditorUI::keyDown") == 0x91a30,
+    "EditorUI::keyDown isn't where address_table_test.bindings puts it"
+);
+
+struct test_build {
+    std::string m_name;
+    bool m_default = false;
+    uint32_t m_timestamp = 0;
+    uint32_t m_checksum = 0;
+    uint32_t m_size = 0;
+    std::vector<std::pair<std::string, uint32_t>> m_bindings;
+};
+
+static size_t g_errors = 0;
+
+static void check(bool ok, std::string const& what) {
+    if (!ok) {
+        std::cerr << what << "\n";
+        g_errors++;
+    }
+}
+
+static uint32_t parseNumber(std::string const& str) {
+    return static_cast<uint32_t>(std::stoul(str, nullptr, 0));
+}
+
+static std::vector<test_build> readBindings(std::string const& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Unable to read " << path << "\n";
+        std::exit(1);
+    }
+    std::vector<test_build> builds;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        std::string word;
+        if (!(ss >> word)) continue;
+
+        if (word == "build") {
+            test_build build;
+            ss >> std::ws;
+            std::getline(ss, build.m_name, '"');
+            std::getline(ss, build.m_name, '"');
+            while (ss >> word) {
+                auto eq = word.find('=');
+                if (word == "default") {
+                    build.m_default = true;
+                } else if (word.substr(0, eq) == "timestamp") {
+                    build.m_timestamp = parseNumber(word.substr(eq + 1));
+                } else if (word.substr(0, eq) == "checksum") {
+                    build.m_checksum = parseNumber(word.substr(eq + 1));
+                } else if (word.substr(0, eq) == "size") {
+                    build.m_size = parseNumber(word.substr(eq + 1));
+                }
+            }
+            builds.push_back(build);
+            continue;
+        }
+        std::string offset;
+        ss >> offset;
+        builds.back().m_bindings.push_back({ word, parseNumber(offset) });
+    }
+    return builds;
+}
+
+// just enough of a PE image for the build 
+// to be recognized: the DOS header's 
+// pointer to the NT headers, the file 
+// header's timestamp and the optional 
+// header's image size & checksum
+static byte_array fakeImage(uint32_t timestamp, uint32_t checksum, uint32_t size) {
+    byte_array image(0x200, 0);
+    image[0] = 'M';
+    image[1] = 'Z';
+    uint32_t nt = 0x80;
+    memcpy(image.data() + 0x3C, &nt, 4);
+    memcpy(image.data() + nt, "PE\0\0", 4);
+    memcpy(image.data() + nt + 8, &timestamp, 4);
+    memcpy(image.data() + nt + 24 + 56, &size, 4);
+    memcpy(image.data() + nt + 24 + 64, &checksum, 4);
+    return image;
+}
+
+static address_table const* findTable(std::string const& name) {
+    for (auto const& table : g_addressTables) {
+        if (table.m_name == name) return &table;
+    }
+    return nullptr;
+}
+
+static void testTable(test_build const& build) {
+    auto table = findTable(build.m_name);
+    if (!table) {
+        check(false, "no table was generated for " + build.m_name);
+        return;
+    }
+    check(
+        table->m_size == build.m_bindings.size(),
+        build.m_name + " has the wrong amount of entries"
+    );
+    for (auto const& [name, offset] : build.m_bindings) {
+        check(
+            AddressTable::find(*table, name.c_str()) == offset,
+            name + " has the wrong offset in " + build.m_name
+        );
+    }
+    check(
+        AddressTable::find(*table, "EditorUI::notBound") == 0 &&
+        AddressTable::find(*table, "") == 0,
+        "a function that isn't bound was found in " + build.m_name
+    );
+}
+
+static void testSelect(std::vector<test_build> const& builds) {
+    test_build const* fallback = nullptr;
+    for (auto const& build : builds) {
+        if (build.m_default) fallback = &build;
+    }
+
+    for (auto const& build : builds) {
+        if (build.m_default) continue;
+        auto image = fakeImage(build.m_timestamp, build.m_checksum, build.m_size);
+        check(AddressTable::buildHash(image.data()) != 0, "a PE header wasn't recognized");
+        auto table = AddressTable::select(image.data());
+        check(
+            table && table->m_name == build.m_name,
+            "the header of " + build.m_name + " didn't select its table"
+        );
+
+        // images are only told apart by these 
+        // three fields, so each one matters
+        for (auto const& other : {
+            fakeImage(build.m_timestamp + 1, build.m_checksum, build.m_size),
+            fakeImage(build.m_timestamp, build.m_checksum + 1, build.m_size),
+            fakeImage(build.m_timestamp, build.m_checksum, build.m_size + 0x1000),
+        }) {
+            auto table = AddressTable::select(other.data());
+            check(
+                fallback ? table && table->m_name == fallback->m_name : !table,
+                "a different build of " + build.m_name + " didn't get the fallback table"
+            );
+        }
+    }
+
+    // not PE images at all
+    auto notMZ = fakeImage(1, 2, 3);
+    notMZ[0] = 'X';
+    auto notPE = fakeImage(1, 2, 3);
+    notPE[0x80] = 'X';
+    for (auto const& image : { notMZ, notPE }) {
+        check(AddressTable::buildHash(image.data()) == 0, "a broken header was hashed");
+        auto table = AddressTable::select(image.data());
+        check(
+            fallback ? table && table->m_name == fallback->m_name : !table,
+            "a broken header didn't get the fallback table"
+        );
+    }
+}
+
+static void testAddressOf(test_build const& build) {
+    auto image = fakeImage(build.m_timestamp, build.m_checksum, build.m_size);
+    AddressTable::loadFrom(image.data());
+    auto table = AddressTable::getCurrent();
+    check(
+        table && table->m_name == build.m_name,
+        "loading " + build.m_name + " picked the wrong table"
+    );
+    auto base = as<uintptr_t>(image.data());
+    for (auto const& [name, offset] : build.m_bindings) {
+        check(
+            AddressTable::addressOf(name.c_str()) == base + offset,
+            name + " has the wrong address in " + build.m_name
+        );
+    }
+    check(
+        AddressTable::addressOf("EditorUI::notBound") == 0,
+        "a function that isn't bound has an address"
+    );
+}
+
+int main() {
+    auto builds = readBindings(ADDRESS_TABLE_BINDINGS);
+    check(builds.size() > 1, "the bindings have less than two builds");
+
+    for (auto const& build : builds) {
+        testTable(build);
+    }
+    testSelect(builds);
+    for (auto const& build : builds) {
+        if (!build.m_default) {
+            testAddressOf(build);
+        }
+    }
+
+    if (g_errors) {
+        std::cerr << g_errors << " address table errors\n";
+        return 1;
+    }
+    std::cout << "checked " << builds.size() << " address tables\n";
+    return 0;
+}
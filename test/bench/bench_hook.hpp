@@ -0,0 +1,89 @@
+#pragma once
+
+// Hooks & functions to hook for the benches 
+// that go straight to the hook engine, 
+// without a mod to own them
+
+#include <HookChain.hpp>
+#include <Memory.hpp>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+// a hook without an owning mod, which the 
+// chains treat like any other
+class BenchHook : public Hook {
+    public:
+        BenchHook(void* address, void* detour, HookMode mode) {
+            m_owner = nullptr;
+            m_address = address;
+            m_detour = detour;
+            m_mode = mode;
+        }
+};
+
+using target_fn = int(*)();
+
+// generate `count` functions that return their 
+// index: mov eax, index; ret. the mov is exactly 
+// what an inline hook overwrites, and it 
+// relocates as-is. never freed, since their hook 
+// chains outlive any hooks placed on them
+inline std::vector<void*> generateTargets(size_t count) {
+    std::vector<void*> targets;
+    for (size_t i = 0; i < count; i++) {
+        auto code = as<uint8_t*>(ExecutableMemory::allocate(16));
+        if (!code) {
+            std::cerr << "Unable to allocate target " << i << "\n";
+            std::exit(1);
+        }
+        auto value = static_cast<uint32_t>(i);
+        memset(code, 0xCC, 16);
+        code[0] = 0xB8;
+        memcpy(code + 1, &value, 4);
+        code[5] = 0xC3;
+        ExecutableMemory::flush(code, 16);
+        targets.push_back(code);
+    }
+    return targets;
+}
+
+// what every generated function is hooked with
+inline int targetDetour() {
+    return -1;
+}
+
+// count the functions that don't return what 
+// they should, hooked or not
+inline size_t verifyTargets(std::vector<void*> const& targets, bool hooked) {
+    size_t errors = 0;
+    for (size_t i = 0; i < targets.size(); i++) {
+        auto res = as<target_fn>(targets[i])();
+        if (res != (hooked ? -1 : static_cast<int>(i))) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// one hook per function, not added to any 
+// chain yet
+inline std::vector<Hook*> createTargetHooks(std::vector<void*> const& targets, HookMode mode) {
+    std::vector<Hook*> hooks;
+    for (auto const& target : targets) {
+        hooks.push_back(new BenchHook(target, as<void*>(&targetDetour), mode));
+    }
+    return hooks;
+}
+
+inline void removeTargetHooks(std::vector<Hook*>& hooks) {
+    for (auto const& hook : hooks) {
+        if (auto chain = HookChain::of(hook)) {
+            chain->remove(hook);
+        }
+        delete hook;
+    }
+    hooks.clear();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// A symbol resolver of its own & a module full 
+// of symbols to resolve, for the resolver's 
+// test & bench. The resolver caches under the 
+// working directory, so they run in a 
+// temporary one
+
+#include <SymbolResolver.hpp>
+#include <Loader.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef LILAC_IS_WINDOWS
+    #include <Windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+USE_LILAC_NAMESPACE();
+
+// a resolver separate from the process-wide 
+// one, so every test starts without a loaded 
+// cache
+class BenchResolver : public SymbolResolver {
+    public:
+        BenchResolver() = default;
+
+        size_t getCachedCount() const {
+            return m_cache.size();
+        }
+
+        Result<module_info*> getModuleInfo(const char* name) {
+            return this->getModule(name);
+        }
+};
+
+// a module every process has loaded, and 
+// symbols it's sure to export
+#ifdef LILAC_IS_WINDOWS
+static constexpr const char* s_benchModule = "kernel32.dll";
+#else
+static constexpr const char* s_benchModule = "libc.so.6";
+#endif
+
+inline std::vector<const char*> const& getBenchSymbols() {
+    static std::vector<const char*> symbols {
+    #ifdef LILAC_IS_WINDOWS
+        "CloseHandle", "CreateEventA", "CreateFileA", "CreateFileW",
+        "CreateThread", "DeleteFileA", "ExitProcess", "FindClose",
+        "FindFirstFileA", "FindNextFileA", "FlushFileBuffers", "FreeLibrary",
+        "GetCurrentProcess", "GetCurrentProcessId", "GetCurrentThread",
+        "GetCurrentThreadId", "GetFileSize", "GetLastError", "GetModuleFileNameA",
+        "GetModuleHandleA", "GetModuleHandleW", "GetProcAddress", "GetProcessHeap",
+        "GetSystemInfo", "GetTickCount", "HeapAlloc", "HeapFree", "LoadLibraryA",
+        "LoadLibraryW", "QueryPerformanceCounter", "QueryPerformanceFrequency",
+        "ReadFile", "SetEvent", "SetLastError", "Sleep", "VirtualAlloc",
+        "VirtualFree", "VirtualProtect", "VirtualQuery", "WaitForSingleObject",
+        "WriteFile",
+    #else
+        "abort", "atoi", "calloc", "close", "exit", "fclose", "fflush",
+        "fopen", "fprintf", "fputs", "fread", "free", "fseek", "ftell",
+        "fwrite", "getenv", "malloc", "memchr", "memcmp", "memcpy", "memmove",
+        "memset", "open", "printf", "puts", "qsort", "read", "realloc",
+        "snprintf", "sprintf", "strchr", "strcmp", "strcpy", "strlen",
+        "strncmp", "strncpy", "strrchr", "strstr", "strtol", "strtoul",
+        "write",
+    #endif
+    };
+    return symbols;
+}
+
+// what the platform says the symbol is at, 
+// to check the resolver against
+inline uintptr_t findBenchSymbol(const char* symbol) {
+    #ifdef LILAC_IS_WINDOWS
+    return as<uintptr_t>(GetProcAddress(GetModuleHandleA(s_benchModule), symbol));
+    #else
+    auto handle = dlopen(s_benchModule, RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) return 0;
+    auto addr = as<uintptr_t>(dlsym(handle, symbol));
+    dlclose(handle);
+    return addr;
+    #endif
+}
+
+// switch to an empty working directory with 
+// a lilac directory in it for the cache
+inline std::filesystem::path enterBenchDirectory(std::string const& name) {
+    auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / lilac_directory);
+    std::filesystem::current_path(dir);
+    return dir;
+}
+
+inline void leaveBenchDirectory(std::filesystem::path const& dir) {
+    std::filesystem::current_path(std::filesystem::temp_directory_path());
+    std::filesystem::remove_all(dir);
+}
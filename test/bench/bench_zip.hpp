@@ -0,0 +1,97 @@
+#pragma once
+
+// Writes .lilac archives for the benches that 
+// need mods on disk
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static uint32_t crc32(std::string const& data) {
+    static auto g_table = []() {
+        std::vector<uint32_t> table(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            auto c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+    uint32_t crc = 0xFFFFFFFF;
+    for (auto const& c : data) {
+        crc = g_table[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+template <class T>
+static void put(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+// write a zip with its entries stored as-is, 
+// which is all the loader needs to read them
+static void writeZip(
+    std::filesystem::path const& path,
+    std::vector<std::pair<std::string, std::string>> const& entries
+) {
+    std::string out;
+    std::string dir;
+    for (auto const& [name, data] : entries) {
+        auto offset = static_cast<uint32_t>(out.size());
+        auto crc = crc32(data);
+        auto size = static_cast<uint32_t>(data.size());
+        auto nameSize = static_cast<uint16_t>(name.size());
+
+        put<uint32_t>(out, 0x04034b50);
+        put<uint16_t>(out, 10);
+        put<uint16_t>(out, 0);
+        put<uint16_t>(out, 0);
+        put<uint32_t>(out, 0);
+        put<uint32_t>(out, crc);
+        put<uint32_t>(out, size);
+        put<uint32_t>(out, size);
+        put<uint16_t>(out, nameSize);
+        put<uint16_t>(out, 0);
+        out += name;
+        out += data;
+
+        put<uint32_t>(dir, 0x02014b50);
+        put<uint16_t>(dir, 20);
+        put<uint16_t>(dir, 10);
+        put<uint16_t>(dir, 0);
+        put<uint16_t>(dir, 0);
+        put<uint32_t>(dir, 0);
+        put<uint32_t>(dir, crc);
+        put<uint32_t>(dir, size);
+        put<uint32_t>(dir, size);
+        put<uint16_t>(dir, nameSize);
+        put<uint16_t>(dir, 0);
+        put<uint16_t>(dir, 0);
+        put<uint16_t>(dir, 0);
+        put<uint16_t>(dir, 0);
+        put<uint32_t>(dir, 0);
+        put<uint32_t>(dir, offset);
+        dir += name;
+    }
+    auto dirOffset = static_cast<uint32_t>(out.size());
+    out += dir;
+    put<uint32_t>(out, 0x06054b50);
+    put<uint16_t>(out, 0);
+    put<uint16_t>(out, 0);
+    put<uint16_t>(out, static_cast<uint16_t>(entries.size()));
+    put<uint16_t>(out, static_cast<uint16_t>(entries.size()));
+    put<uint32_t>(out, static_cast<uint32_t>(dir.size()));
+    put<uint32_t>(out, dirOffset);
+    put<uint16_t>(out, 0);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), out.size());
+}
@@ -0,0 +1,253 @@
+// Measures the executable memory hook stubs & trampolines are 
+// allocated from: how long allocating & freeing a block takes, 
+// how densely blocks are packed into slabs, whether freed blocks 
+// are reused, how much executable memory hooking 100, 1000 
+// and 10000 functions takes per hook, and how long reclaiming 
+// the stubs of removed hooks takes. Every block must be 
+// within rel32 range of the address it was allocated near, 
+// and freeing every block must give every slab back. Results 
+// are printed as JSON; the exit code is nonzero if a block was 
+// out of range or overlapped another, freed memory wasn't 
+// reused or given back, the stubs of removed hooks weren't 
+// reclaimed, or a hook didn't install or reach its detour.
+//
+// usage: lilac_executable_memory_bench [--out file.json]
+
+#include "bench_hook.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+struct bench_result {
+    std::string m_name;
+    size_t m_count;
+    double m_nsPerItem;
+    size_t m_slabs;
+    double m_bytesPerItem;
+    double m_itemsPerPage;
+};
+
+static constexpr const size_t s_blockSize = 16;
+
+// blocks out of range or overlapping, memory 
+// that wasn't reused or given back, and hooks 
+// that didn't work
+static size_t g_errors = 0;
+
+static void error(std::string const& what) {
+    std::cerr << what << "\n";
+    g_errors++;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// a function in this binary, like the 
+// functions stubs are allocated near
+static int nearTarget() {
+    return 0;
+}
+
+// pages the blocks are spread over
+static size_t countPages(std::vector<void*> const& blocks) {
+    std::vector<uintptr_t> pages;
+    for (auto const& block : blocks) {
+        pages.push_back(PageUnprotect::pageOf(as<uintptr_t>(block)));
+    }
+    std::sort(pages.begin(), pages.end());
+    return std::unique(pages.begin(), pages.end()) - pages.begin();
+}
+
+static void verifyBlocks(std::vector<void*> blocks, void* near) {
+    std::sort(blocks.begin(), blocks.end());
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (!blocks[i]) {
+            error("a block wasn't allocated");
+            return;
+        }
+        if (!ExecutableMemory::isNear(blocks[i], s_blockSize, near)) {
+            error("a block is out of rel32 range of its target");
+            return;
+        }
+        if (i && as<uint8_t*>(blocks[i - 1]) + s_blockSize > blocks[i]) {
+            error("two blocks overlap");
+            return;
+        }
+    }
+}
+
+static void benchAllocation(std::vector<bench_result>& results, size_t count) {
+    auto near = as<void*>(&nearTarget);
+    auto slabs = ExecutableMemory::getSlabCount();
+
+    std::vector<void*> blocks;
+    blocks.reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        blocks.push_back(ExecutableMemory::allocate(s_blockSize, near));
+    }
+    auto allocNs = elapsedNs(start);
+    verifyBlocks(blocks, near);
+
+    auto usedSlabs = ExecutableMemory::getSlabCount() - slabs;
+    auto perPage = static_cast<double>(count) / countPages(blocks);
+    results.push_back({
+        "allocate", count, allocNs / count, usedSlabs,
+        static_cast<double>(s_blockSize), perPage
+    });
+
+    // free every other block and allocate them 
+    // again, which has to reuse the freed ones
+    for (size_t i = 0; i < count; i += 2) {
+        ExecutableMemory::free(blocks[i]);
+        blocks[i] = nullptr;
+    }
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i += 2) {
+        blocks[i] = ExecutableMemory::allocate(s_blockSize, near);
+    }
+    auto reuseNs = elapsedNs(start);
+    verifyBlocks(blocks, near);
+    if (ExecutableMemory::getSlabCount() - slabs != usedSlabs) {
+        error("freed blocks weren't reused");
+    }
+    results.push_back({
+        "reallocate", (count + 1) / 2, reuseNs / ((count + 1) / 2), usedSlabs,
+        static_cast<double>(s_blockSize), static_cast<double>(count) / countPages(blocks)
+    });
+
+    start = std::chrono::steady_clock::now();
+    for (auto const& block : blocks) {
+        ExecutableMemory::free(block);
+    }
+    auto freeNs = elapsedNs(start);
+    if (ExecutableMemory::getSlabCount() != slabs) {
+        error("empty slabs weren't given back");
+    }
+    results.push_back({ "free", count, freeNs / count, 0, 0, 0 });
+}
+
+static void addHooks(std::vector<Hook*> const& hooks) {
+    for (auto const& hook : hooks) {
+        auto chain = HookChain::get(as<void*>(hook->getAddress()));
+        auto link = chain->add(hook);
+        if (!link) {
+            error(link.error());
+            continue;
+        }
+        auto res = chain->enable(hook);
+        if (!res) {
+            error(res.error());
+        }
+    }
+}
+
+static void benchHooks(std::vector<bench_result>& results, size_t count) {
+    auto targets = generateTargets(count);
+    g_errors += verifyTargets(targets, false);
+    auto hooks = createTargetHooks(targets, HookMode::Inline);
+
+    auto slabs = ExecutableMemory::getSlabCount();
+    auto size = ExecutableMemory::getAllocatedSize();
+    auto start = std::chrono::steady_clock::now();
+    addHooks(hooks);
+    auto hookNs = elapsedNs(start);
+    g_errors += verifyTargets(targets, true);
+
+    // stubs & trampolines, but not the chains 
+    // or hooks themselves. they're packed 
+    // back to back like the blocks above, so 
+    // a page holds as many hooks as fit
+    auto usedSlabs = ExecutableMemory::getSlabCount() - slabs;
+    auto perHook = static_cast<double>(ExecutableMemory::getAllocatedSize() - size) / count;
+    results.push_back({
+        "hook", count, hookNs / count, usedSlabs,
+        perHook, PageUnprotect::pageSize() / std::max(perHook, 1.0)
+    });
+
+    // the stubs of removed hooks are retired; 
+    // nothing can be running in them here, so 
+    // skip the grace period
+    removeTargetHooks(hooks);
+    g_errors += verifyTargets(targets, false);
+    start = std::chrono::steady_clock::now();
+    auto reclaimed = ExecutableMemory::reclaim(std::chrono::milliseconds(0));
+    auto reclaimNs = elapsedNs(start);
+    if (reclaimed != count) {
+        error("the stubs of removed hooks weren't reclaimed");
+    }
+    results.push_back({
+        "reclaim", count, reclaimNs / count, 0,
+        static_cast<double>(size + perHook * count - ExecutableMemory::getAllocatedSize()) / count, 0
+    });
+
+    // hooking the same functions again 
+    // has to reuse the reclaimed stubs
+    hooks = createTargetHooks(targets, HookMode::Inline);
+    addHooks(hooks);
+    g_errors += verifyTargets(targets, true);
+    if (ExecutableMemory::getSlabCount() - slabs > usedSlabs) {
+        error("reclaimed stubs weren't reused");
+    }
+    removeTargetHooks(hooks);
+    ExecutableMemory::reclaim(std::chrono::milliseconds(0));
+    g_errors += verifyTargets(targets, false);
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_executable_memory_bench\",\n";
+    ss << "    \"page_size\": " << PageUnprotect::pageSize() << ",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"count\": " << results[i].m_count << ", "
+           << "\"ns_per_item\": " << results[i].m_nsPerItem << ", "
+           << "\"slabs\": " << results[i].m_slabs << ", "
+           << "\"bytes_per_item\": " << results[i].m_bytesPerItem << ", "
+           << "\"items_per_page\": " << results[i].m_itemsPerPage
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    std::vector<bench_result> results;
+    for (size_t count : { 100, 1000, 10000 }) {
+        benchAllocation(results, count);
+    }
+    for (size_t count : { 100, 1000, 10000 }) {
+        benchHooks(results, count);
+    }
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " executable memory errors\n";
+        return 1;
+    }
+    return 0;
+}
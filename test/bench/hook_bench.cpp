@@ -0,0 +1,310 @@
+// Measures what a hook costs per call. Hooks are placed on 
+// functions inside this binary straight through their hook 
+// chains, so they go through the same stubs & hook engine 
+// as any mod's hooks would, without needing the rest of the 
+// loader around them. Every hooked phase is run once in 
+// trap mode and once in inline mode. Results are printed 
+// as JSON; the exit code is nonzero if any hooked call 
+// returned the wrong result or went uncounted by the 
+// instrumentation, so it doubles as a stress test for 
+// toggling hooks under concurrent calls.
+//
+// usage: lilac_hook_bench [--iterations N] [--out file.json]
+
+#include "bench_hook.hpp"
+#include <HookInstrumentation.hpp>
+#include <utils/casts.hpp>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+#ifdef _MSC_VER
+    #define BENCH_NOINLINE __declspec(noinline)
+#else
+    #define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+using bench_fn = int(*)(int);
+
+static volatile int g_sink;
+
+BENCH_NOINLINE int benchTarget(int x) {
+    g_sink = x;
+    return x * 3 + 1;
+}
+
+// called through a volatile pointer so the 
+// compiler can't inline or skip the call
+static bench_fn volatile g_target = &benchTarget;
+
+BENCH_NOINLINE int replaceDetour(int x) {
+    g_sink = x;
+    return x * 3 + 1;
+}
+
+template <int I>
+struct StackedDetour {
+    static inline bench_fn s_original = nullptr;
+
+    BENCH_NOINLINE static int detour(int x) {
+        return s_original(x);
+    }
+};
+
+struct bench_result {
+    std::string m_name;
+    std::string m_mode;
+    double m_nsPerCall;
+    size_t m_hooks;
+};
+
+// mode of the hooks being added
+static HookMode g_mode = HookMode::Trap;
+// calls that returned the wrong result or 
+// weren't counted by the instrumentation
+static std::atomic<size_t> g_errors = 0;
+
+// runs per measurement
+static constexpr const size_t s_runs = 5;
+
+static double measure(size_t iterations) {
+    // best of a few runs, to shave off noise
+    double best = 1e300;
+    for (size_t run = 0; run < s_runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        int acc = 0;
+        for (size_t i = 0; i < iterations; i++) {
+            acc += g_target(static_cast<int>(i));
+        }
+        auto end = std::chrono::steady_clock::now();
+        g_sink = acc;
+        auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+        best = std::min(best, ns / iterations);
+    }
+    return best;
+}
+
+static HookChain* chain() {
+    return HookChain::get(as<void*>(&benchTarget));
+}
+
+static Hook* addStacked(std::vector<Hook*>& hooks, void* detour, bench_fn* original) {
+    auto hook = new BenchHook(as<void*>(&benchTarget), detour, g_mode);
+    auto res = chain()->add(hook);
+    if (!res) {
+        std::cerr << "Unable to add hook: " << res.error() << "\n";
+        std::exit(1);
+    }
+    if (original) {
+        *original = as<bench_fn>(res.value());
+    }
+    auto enable = chain()->enable(hook);
+    if (!enable) {
+        std::cerr << "Unable to enable hook: " << enable.error() << "\n";
+        std::exit(1);
+    }
+    hooks.push_back(hook);
+    return hook;
+}
+
+static void removeAll(std::vector<Hook*>& hooks) {
+    for (auto const& hook : hooks) {
+        chain()->remove(hook);
+        // the chain keeps nothing pointing 
+        // at the hook once it's removed
+        delete hook;
+    }
+    hooks.clear();
+}
+
+template <int... I>
+static void addStackedDetours(std::vector<Hook*>& hooks, std::integer_sequence<int, I...>) {
+    (addStacked(
+        hooks,
+        as<void*>(&StackedDetour<I>::detour),
+        &StackedDetour<I>::s_original
+    ), ...);
+}
+
+static std::string toJSON(std::vector<bench_result> const& results, size_t iterations) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_hook_bench\",\n";
+    ss << "    \"iterations\": " << iterations << ",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"mode\": \"" << results[i].m_mode << "\", "
+           << "\"hooks\": " << results[i].m_hooks << ", "
+           << "\"ns_per_call\": " << results[i].m_nsPerCall
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+// every hooked phase, with hooks of one mode
+static void runHooked(std::vector<bench_result>& results, size_t iterations, HookMode mode) {
+    g_mode = mode;
+    std::string modeName = mode == HookMode::Inline ? "inline" : "trap";
+    std::vector<Hook*> hooks;
+
+    // one detour that replaces the function
+    addStacked(hooks, as<void*>(&replaceDetour), nullptr);
+    results.push_back({ "replace", modeName, measure(iterations), 1 });
+    removeAll(hooks);
+
+    // one detour that calls the original
+    addStackedDetours(hooks, std::make_integer_sequence<int, 1>());
+    results.push_back({ "call_original", modeName, measure(iterations), 1 });
+    removeAll(hooks);
+
+    // detours stacked on top of each other, 
+    // each continuing down the chain
+    addStackedDetours(hooks, std::make_integer_sequence<int, 4>());
+    results.push_back({ "stacked", modeName, measure(iterations), 4 });
+    removeAll(hooks);
+
+    addStackedDetours(hooks, std::make_integer_sequence<int, 16>());
+    results.push_back({ "stacked", modeName, measure(iterations), 16 });
+    removeAll(hooks);
+
+    // the same detour with instrumentation on, 
+    // and then off again, when it should cost 
+    // exactly what call_original did
+    {
+        auto hook = addStacked(
+            hooks,
+            as<void*>(&StackedDetour<0>::detour),
+            &StackedDetour<0>::s_original
+        );
+        auto on = HookInstrumentation::setEnabled(true);
+        if (!on) {
+            std::cerr << "Unable to enable instrumentation: " << on.error() << "\n";
+            std::exit(1);
+        }
+        HookInstrumentation::reset();
+        results.push_back({ "instrumented", modeName, measure(iterations), 1 });
+        // every call has to have been counted
+        auto calls = hook->getStats().m_calls;
+        auto expected = iterations * s_runs;
+        g_errors += calls > expected ? calls - expected : expected - calls;
+
+        HookInstrumentation::setEnabled(false);
+        results.push_back({ "instrumentation_off", modeName, measure(iterations), 1 });
+        removeAll(hooks);
+    }
+
+    // one hook being disabled & enabled over and 
+    // over on another thread while being called
+    {
+        auto hook = addStacked(
+            hooks,
+            as<void*>(&StackedDetour<0>::detour),
+            &StackedDetour<0>::s_original
+        );
+        std::atomic<bool> done = false;
+        std::atomic<size_t> toggles = 0;
+        std::thread toggler([&]() {
+            while (!done) {
+                chain()->disable(hook);
+                chain()->enable(hook);
+                toggles++;
+            }
+        });
+        auto ns = measure(iterations);
+        done = true;
+        toggler.join();
+        results.push_back({ "toggled_under_load", modeName, ns, 1 });
+        removeAll(hooks);
+        std::cerr << toggles << " toggles during toggled_under_load (" << modeName << ")\n";
+    }
+
+    // several threads calling while the hook is 
+    // toggled; every call has to return the right 
+    // result whether it went through the detour 
+    // and the original or straight to the original
+    {
+        auto hook = addStacked(
+            hooks,
+            as<void*>(&StackedDetour<0>::detour),
+            &StackedDetour<0>::s_original
+        );
+        auto threads = std::max(3u, std::thread::hardware_concurrency()) - 1;
+        std::atomic<bool> done = false;
+        std::thread toggler([&]() {
+            while (!done) {
+                chain()->disable(hook);
+                chain()->enable(hook);
+            }
+        });
+        std::vector<std::thread> callers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            callers.emplace_back([&]() {
+                size_t errors = 0;
+                for (size_t i = 0; i < iterations; i++) {
+                    auto x = static_cast<int>(i & 0xFFFFF);
+                    if (g_target(x) != x * 3 + 1) {
+                        errors++;
+                    }
+                }
+                g_errors += errors;
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        auto end = std::chrono::steady_clock::now();
+        done = true;
+        toggler.join();
+        auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+        results.push_back({ "toggled_contended", modeName, ns / iterations, 1 });
+        removeAll(hooks);
+        std::cerr << threads << " threads during toggled_contended (" << modeName << ")\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = 1000000;
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::stoull(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    std::vector<bench_result> results;
+
+    results.push_back({ "direct", "none", measure(iterations), 0 });
+
+    runHooked(results, iterations, HookMode::Trap);
+    runHooked(results, iterations, HookMode::Inline);
+
+    auto json = toJSON(results, iterations);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " calls returned the wrong result\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Measures what hooks cost at startup when they're installed 
+// eagerly, in the startup transaction, versus when they're 
+// lazy and only join their hook chains, plus what it costs 
+// to install the lazy ones later when their trigger fires. 
+// Every hook gets its own generated function, for 100, 1000 
+// and 10000 hooks, in trap and inline mode. Results are 
+// printed as JSON; the exit code is nonzero if a hook 
+// failed to install, or a function reached its detour 
+// while it shouldn't have or the other way around.
+//
+// usage: lilac_hook_startup_bench [--out file.json]
+
+#include "bench_hook.hpp"
+#include <HookTransaction.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+struct bench_result {
+    std::string m_name;
+    std::string m_mode;
+    size_t m_hooks;
+    double m_ms;
+};
+
+// hooks that didn't install or functions 
+// that returned the wrong thing
+static size_t g_errors = 0;
+
+template <class Func>
+static double timed(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// every hook installed at startup, which is 
+// what loadHooks does with non-lazy hooks
+static double eager(std::vector<Hook*> const& hooks) {
+    return timed([&]() {
+        HookTransaction transaction;
+        transaction.begin();
+        for (auto const& hook : hooks) {
+            transaction.add(nullptr, hook);
+        }
+        auto res = transaction.commit();
+        if (!res) {
+            std::cerr << res.error() << "\n";
+            g_errors++;
+        }
+    });
+}
+
+// lazy hooks only join their chain at 
+// startup, which writes no code
+static double lazy(std::vector<Hook*> const& hooks) {
+    return timed([&]() {
+        for (auto const& hook : hooks) {
+            auto res = HookChain::get(as<void*>(hook->getAddress()))->add(hook);
+            if (!res) {
+                std::cerr << res.error() << "\n";
+                g_errors++;
+            }
+        }
+    });
+}
+
+// the trigger firing later, which enables 
+// its hooks one by one
+static double trigger(std::vector<Hook*> const& hooks) {
+    return timed([&]() {
+        for (auto const& hook : hooks) {
+            auto chain = HookChain::of(hook);
+            auto res = chain ? chain->enable(hook) : Err<>("Hook lacks a handle");
+            if (!res) {
+                std::cerr << res.error() << "\n";
+                g_errors++;
+            }
+        }
+    });
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_hook_startup_bench\",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"mode\": \"" << results[i].m_mode << "\", "
+           << "\"hooks\": " << results[i].m_hooks << ", "
+           << "\"ms\": " << results[i].m_ms
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    std::vector<bench_result> results;
+    for (size_t count : { 100, 1000, 10000 }) {
+        auto targets = generateTargets(count);
+        g_errors += verifyTargets(targets, false);
+
+        for (auto mode : { HookMode::Trap, HookMode::Inline }) {
+            std::string modeName = mode == HookMode::Inline ? "inline" : "trap";
+            // best of a few runs
+            double eagerMs = 1e300, lazyMs = 1e300, triggerMs = 1e300;
+            for (int run = 0; run < 3; run++) {
+                auto hooks = createTargetHooks(targets, mode);
+                eagerMs = std::min(eagerMs, eager(hooks));
+                g_errors += verifyTargets(targets, true);
+                removeTargetHooks(hooks);
+
+                hooks = createTargetHooks(targets, mode);
+                lazyMs = std::min(lazyMs, lazy(hooks));
+                g_errors += verifyTargets(targets, false);
+                triggerMs = std::min(triggerMs, trigger(hooks));
+                g_errors += verifyTargets(targets, true);
+                removeTargetHooks(hooks);
+                g_errors += verifyTargets(targets, false);
+            }
+            results.push_back({ "eager", modeName, count, eagerMs });
+            results.push_back({ "lazy", modeName, count, lazyMs });
+            results.push_back({ "lazy_trigger", modeName, count, triggerMs });
+        }
+    }
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " hooks failed to install or behaved wrong\n";
+        return 1;
+    }
+    return 0;
+}
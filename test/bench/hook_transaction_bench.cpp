@@ -0,0 +1,139 @@
+// Measures how long it takes to install a batch of hooks in 
+// one HookTransaction versus enabling them one by one, for 
+// 1, 100 and 10000 hooks. No binary has 10000 functions to 
+// spare, so every hook gets its own tiny function generated 
+// into executable memory. Every phase is run once in trap 
+// mode and once in inline mode. Results are printed as 
+// JSON; the exit code is nonzero if a hook failed to 
+// install or a hooked function didn't reach its detour.
+//
+// usage: lilac_hook_transaction_bench [--out file.json]
+
+#include "bench_hook.hpp"
+#include <HookTransaction.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+struct bench_result {
+    std::string m_name;
+    std::string m_mode;
+    size_t m_hooks;
+    double m_ms;
+};
+
+// hooks that didn't install or functions 
+// that didn't reach the detour
+static size_t g_errors = 0;
+
+static void installTransaction(std::vector<Hook*> const& hooks) {
+    HookTransaction transaction;
+    transaction.begin();
+    for (auto const& hook : hooks) {
+        transaction.add(nullptr, hook);
+    }
+    auto res = transaction.commit();
+    if (!res) {
+        std::cerr << res.error() << "\n";
+        g_errors++;
+    }
+}
+
+static void installOneByOne(std::vector<Hook*> const& hooks) {
+    for (auto const& hook : hooks) {
+        auto chain = HookChain::get(as<void*>(hook->getAddress()));
+        auto link = chain->add(hook);
+        if (!link) {
+            std::cerr << link.error() << "\n";
+            g_errors++;
+            continue;
+        }
+        auto res = chain->enable(hook);
+        if (!res) {
+            std::cerr << res.error() << "\n";
+            g_errors++;
+        }
+    }
+}
+
+// best of a few runs, in milliseconds. 
+// the hooks are removed again after every 
+// run, which isn't measured
+template <class Func>
+static double measure(std::vector<void*> const& targets, HookMode mode, Func install) {
+    double best = 1e300;
+    for (int run = 0; run < 3; run++) {
+        auto hooks = createTargetHooks(targets, mode);
+        auto start = std::chrono::steady_clock::now();
+        install(hooks);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        g_errors += verifyTargets(targets, true);
+        removeTargetHooks(hooks);
+        g_errors += verifyTargets(targets, false);
+    }
+    return best;
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_hook_transaction_bench\",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"mode\": \"" << results[i].m_mode << "\", "
+           << "\"hooks\": " << results[i].m_hooks << ", "
+           << "\"ms\": " << results[i].m_ms
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    std::vector<bench_result> results;
+    for (size_t count : { 1, 100, 10000 }) {
+        auto targets = generateTargets(count);
+        g_errors += verifyTargets(targets, false);
+
+        for (auto mode : { HookMode::Trap, HookMode::Inline }) {
+            std::string modeName = mode == HookMode::Inline ? "inline" : "trap";
+            results.push_back({
+                "transaction", modeName, count, measure(targets, mode, installTransaction)
+            });
+            results.push_back({
+                "one_by_one", modeName, count, measure(targets, mode, installOneByOne)
+            });
+        }
+    }
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " hooks failed to install or reach their detour\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+// Checks import hooks against a pair of shared libraries: one 
+// exporting a function, which this test links against, and one 
+// importing it, which is loaded at runtime after the hook is 
+// created. Installing the hook has to redirect the calls from 
+// both, including the library's slot that hasn't been bound 
+// yet, while calling the function directly still runs the 
+// original and its code is never modified. Uninstalling has to 
+// put every slot back, and the same goes for a hook chain in 
+// import mode. Functions nothing imports can't be import hooked.
+//
+// usage: lilac_import_hook_test
+
+#include "bench_hook.hpp"
+#include <ImportHook.hpp>
+#include <cstring>
+
+#ifdef LILAC_IS_WINDOWS
+    #include <Windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+extern "C" int lilac_import_target(int value);
+
+using import_fn = int(*)(int);
+
+static size_t g_errors = 0;
+
+static void check(bool ok, std::string const& what) {
+    if (!ok) {
+        std::cerr << what << "\n";
+        g_errors++;
+    }
+}
+
+static int importDetour(int value) {
+    return -value;
+}
+
+static int notImported(int value) {
+    return value * 2;
+}
+
+static void* loadLibrary(const char* path) {
+    #ifdef LILAC_IS_WINDOWS
+    return LoadLibraryA(path);
+    #else
+    // lazily, so the caller's import isn't 
+    // bound until it's first called
+    return dlopen(path, RTLD_LAZY);
+    #endif
+}
+
+static void* findSymbol(void* library, const char* name) {
+    #ifdef LILAC_IS_WINDOWS
+    return as<void*>(GetProcAddress(as<HMODULE>(library), name));
+    #else
+    return dlsym(library, name);
+    #endif
+}
+
+static import_fn g_target = nullptr;
+static import_fn g_caller = nullptr;
+
+// calls from this binary, from the other 
+// library & straight to the function
+static void expectCalls(bool hooked, std::string const& when) {
+    check(
+        lilac_import_target(5) == (hooked ? -5 : 6),
+        "a call from the test went to the wrong function " + when
+    );
+    check(
+        g_caller(7) == (hooked ? -7 : 8),
+        "a call from the caller library went to the wrong function " + when
+    );
+    check(g_target(9) == 10, "a direct call didn't run the original " + when);
+}
+
+static void testImportHook(ImportHook* hook, uint8_t const* code) {
+    // twice: once while the caller's slot is 
+    // still unbound, and once after its calls 
+    // have bound it
+    for (auto const& when : { "(unbound)", "(bound)" }) {
+        auto install = hook->install();
+        if (!install) {
+            check(false, install.error());
+            continue;
+        }
+        check(hook->isInstalled(), std::string("the hook isn't installed ") + when);
+        check(
+            hook->getSlotCount() >= 2,
+            std::string("the hook didn't find both imports ") + when
+        );
+        expectCalls(true, std::string("while hooked ") + when);
+
+        auto uninstall = hook->uninstall();
+        if (!uninstall) {
+            check(false, uninstall.error());
+        }
+        check(!hook->isInstalled(), std::string("the hook is still installed ") + when);
+        expectCalls(false, std::string("after unhooking ") + when);
+    }
+
+    uint8_t after[16];
+    memcpy(after, as<void*>(g_target), sizeof(after));
+    check(!memcmp(code, after, sizeof(after)), "the hooked function's code changed");
+
+    // deleting it uninstalls again, with 
+    // nothing left to put back
+    delete hook;
+    expectCalls(false, "after deleting the hook");
+}
+
+static void testHookChain() {
+    BenchHook hook(as<void*>(g_target), as<void*>(&importDetour), HookMode::Import);
+    auto chain = HookChain::get(as<void*>(g_target));
+    auto link = chain->add(&hook);
+    if (!link) {
+        check(false, link.error());
+        return;
+    }
+    auto res = chain->enable(&hook);
+    if (!res) {
+        check(false, res.error());
+    }
+    expectCalls(true, "through a hook chain");
+
+    res = chain->disable(&hook);
+    if (!res) {
+        check(false, res.error());
+    }
+    expectCalls(false, "after disabling the chain's hook");
+    chain->remove(&hook);
+    expectCalls(false, "after removing the chain's hook");
+}
+
+int main() {
+    // looked up rather than taken with &, so 
+    // this binary's own reference to it stays 
+    // an import
+    #ifdef LILAC_IS_WINDOWS
+    auto target = GetModuleHandleA(IMPORT_TEST_TARGET);
+    #else
+    auto target = dlopen(IMPORT_TEST_TARGET, RTLD_LAZY | RTLD_NOLOAD);
+    #endif
+    g_target = target ? as<import_fn>(findSymbol(target, "lilac_import_target")) : nullptr;
+    if (!g_target) {
+        std::cerr << "Unable to find lilac_import_target\n";
+        return 1;
+    }
+    uint8_t code[16];
+    memcpy(code, as<void*>(g_target), sizeof(code));
+
+    // created before the caller is loaded, 
+    // which install has to pick up anyway
+    auto hook = ImportHook::create(as<void*>(g_target), as<void*>(&importDetour));
+
+    auto caller = loadLibrary(IMPORT_TEST_CALLER);
+    g_caller = caller ? as<import_fn>(findSymbol(caller, "lilac_import_caller")) : nullptr;
+    if (!g_caller) {
+        std::cerr << "Unable to find lilac_import_caller\n";
+        return 1;
+    }
+
+    if (hook) {
+        testImportHook(hook.value(), code);
+    } else {
+        check(false, hook.error());
+    }
+    testHookChain();
+
+    check(
+        !ImportHook::create(as<void*>(&notImported), as<void*>(&importDetour)),
+        "a function nothing imports was import hooked"
+    );
+
+    if (g_errors) {
+        std::cerr << g_errors << " import hook errors\n";
+        return 1;
+    }
+    std::cout << "import hooks redirected & restored every call\n";
+    return 0;
+}
@@ -0,0 +1,26 @@
+// Shared libraries for lilac_import_hook_test. Built once as the 
+// library that exports the function to hook, and once with 
+// IMPORT_TEST_CALLER defined as a library that imports it, which 
+// the test loads at runtime.
+
+#ifdef _WIN32
+    #define IMPORT_TEST_EXPORT __declspec(dllexport)
+#else
+    #define IMPORT_TEST_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef IMPORT_TEST_CALLER
+
+extern "C" int lilac_import_target(int value);
+
+extern "C" IMPORT_TEST_EXPORT int lilac_import_caller(int value) {
+    return lilac_import_target(value);
+}
+
+#else
+
+extern "C" IMPORT_TEST_EXPORT int lilac_import_target(int value) {
+    return value + 1;
+}
+
+#endif
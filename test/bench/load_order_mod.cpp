@@ -0,0 +1,23 @@
+// Mod binary for lilac_load_order_test. Built once per test mod, 
+// with LOAD_ORDER_MOD set to a different name each time so that 
+// every build is a distinct binary.
+
+#include <lilac.hpp>
+
+USE_LILAC_NAMESPACE();
+
+class LoadOrderMod : public Mod {
+    protected:
+        void setup() override {}
+
+    public:
+        static LoadOrderMod* get() {
+            return new LoadOrderMod;
+        }
+};
+
+extern "C" __declspec(dllexport) const char* load_order_mod_name() {
+    return LOAD_ORDER_MOD;
+}
+
+LILAC_LOAD(LoadOrderMod);
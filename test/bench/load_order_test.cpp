@@ -0,0 +1,104 @@
+// Loads a set of mods through the real loader and checks that each 
+// one is loaded after its dependencies, that none are left 
+// unresolved, and that loading one mod doesn't take another off 
+// the unresolved list. The mods are written into lilac/mods under 
+// a temporary working directory; the dependent mod sorts before 
+// its dependency, and a third mod sorts after both, so the 
+// dependency is neither the first nor the last mod waiting to 
+// be loaded. Windows only, as loading goes through LoadLibrary.
+//
+// usage: lilac_load_order_test
+
+#include <lilac.hpp>
+#include "bench_zip.hpp"
+#include <algorithm>
+#include <iostream>
+
+USE_LILAC_NAMESPACE();
+
+struct test_mod {
+    std::string m_file;
+    std::string m_id;
+    std::string m_dependency;
+    std::string m_binary;
+};
+
+static std::string readFile(std::string const& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+static void writeMod(std::filesystem::path const& dir, test_mod const& mod) {
+    auto binaryName = std::filesystem::path(mod.m_binary).filename().string();
+    std::string json = 
+        "{\n"
+        "    \"lilac\": 1,\n"
+        "    \"id\": \"" + mod.m_id + "\",\n"
+        "    \"version\": \"v1.0.0\",\n"
+        "    \"name\": \"" + mod.m_id + "\",\n"
+        "    \"developer\": \"Test\",\n"
+        "    \"windowsBinary\": \"" + binaryName + "\",\n"
+        "    \"dependencies\": [";
+    if (mod.m_dependency.size()) {
+        json += "{ \"id\": \"" + mod.m_dependency + "\", \"required\": true }";
+    }
+    json += "]\n}\n";
+    writeZip(dir / mod.m_file, {
+        { "mod.json", json },
+        { binaryName, readFile(mod.m_binary) },
+    });
+}
+
+int main() {
+    std::vector<test_mod> mods {
+        { "a_dependent.lilac", "test.load.dependent", "test.load.base", LOAD_ORDER_MOD_A },
+        { "b_base.lilac",      "test.load.base",      "",               LOAD_ORDER_MOD_B },
+        { "c_other.lilac",     "test.load.other",     "",               LOAD_ORDER_MOD_C },
+    };
+
+    auto dir = std::filesystem::temp_directory_path() / "lilac_load_order_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / lilac_directory / lilac_mod_directory);
+    std::filesystem::current_path(dir);
+    for (auto const& mod : mods) {
+        writeMod(dir / lilac_directory / lilac_mod_directory, mod);
+    }
+
+    size_t errors = 0;
+    auto loaded = Loader::get()->updateMods();
+    if (loaded != mods.size()) {
+        std::cerr << "loaded " << loaded << " of " << mods.size() << " mods\n";
+        errors++;
+    }
+    for (auto const& mod : Loader::get()->getUnresolvedMods()) {
+        std::cerr << mod->m_info.m_id << " was left unresolved\n";
+        errors++;
+    }
+
+    std::vector<std::string> order;
+    for (auto const& mod : Loader::get()->getLoadedMods()) {
+        order.push_back(mod->getID());
+    }
+    for (auto const& mod : mods) {
+        auto pos = std::find(order.begin(), order.end(), mod.m_id);
+        if (pos == order.end()) {
+            std::cerr << mod.m_id << " wasn't loaded\n";
+            errors++;
+            continue;
+        }
+        if (mod.m_dependency.size()) {
+            auto dep = std::find(order.begin(), order.end(), mod.m_dependency);
+            if (dep == order.end() || dep > pos) {
+                std::cerr << mod.m_id << " was loaded before " << mod.m_dependency << "\n";
+                errors++;
+            }
+        }
+    }
+
+    if (errors) {
+        std::cerr << errors << " load order errors\n";
+        return 1;
+    }
+    std::cout << "loaded " << loaded << " mods in order\n";
+    return 0;
+}
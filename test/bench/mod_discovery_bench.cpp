@@ -0,0 +1,242 @@
+// Measures how long it takes to discover a directory of mods, 
+// reading & parsing the mod.json of every .lilac file one by 
+// one versus on the loader's worker pool, and how long it 
+// takes to order them into a load plan. The mods are 
+// generated into a temporary directory; each one depends on 
+// a few of the others and carries a dummy binary so that the 
+// archives have a realistic size. On Linux the files are 
+// dropped from the page cache before every run so reads hit 
+// the disk like they would on a cold start. Results are 
+// printed as JSON; the exit code is nonzero if any mod failed 
+// to read or the plan put a mod before its dependencies.
+//
+// usage: lilac_mod_discovery_bench [--binary-kb N] [--out file.json]
+
+#include <Loader.hpp>
+#include <Mod.hpp>
+#include "bench_zip.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+USE_LILAC_NAMESPACE();
+
+// only here to get at the load planner
+class BenchLoader : public Loader {
+    public:
+        using Loader::LoadPlan;
+        using Loader::planLoadOrder;
+};
+
+struct bench_result {
+    std::string m_name;
+    size_t m_mods;
+    unsigned m_threads;
+    double m_ms;
+};
+
+// mods that didn't read or plan right
+static size_t g_errors = 0;
+
+static std::string modID(size_t i) {
+    return "bench.mod" + std::to_string(i);
+}
+
+// generate `count` mods, each depending on up to 
+// three mods with a higher index so that a plain 
+// alphabetical load order gets them wrong
+static std::vector<std::string> generateMods(
+    std::filesystem::path const& dir,
+    size_t count,
+    size_t binarySize
+) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::mt19937 rng(1234);
+    std::string binary(binarySize, '\0');
+    for (auto& c : binary) {
+        c = static_cast<char>(rng());
+    }
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; i++) {
+        std::stringstream json;
+        json << "{\n"
+             << "    \"lilac\": 1,\n"
+             << "    \"id\": \"" << modID(i) << "\",\n"
+             << "    \"version\": \"v1.0.0\",\n"
+             << "    \"name\": \"Bench Mod " << i << "\",\n"
+             << "    \"developer\": \"Bench\",\n"
+             << "    \"description\": \"Generated for lilac_mod_discovery_bench\",\n"
+             << "    \"dependencies\": [";
+        size_t deps = 0;
+        for (size_t j = i + 1; j < count && deps < 3; j++) {
+            if (rng() % 4) continue;
+            json << (deps++ ? ", " : "")
+                 << "{ \"id\": \"" << modID(j) << "\", \"required\": true }";
+        }
+        json << "]\n}\n";
+
+        auto path = dir / (modID(i) + std::string(lilac_mod_extension));
+        writeZip(path, {
+            { "mod.json", json.str() },
+            { "mod.dll", binary },
+            { "mod.dylib", binary },
+            { "mod.so", binary },
+        });
+        paths.push_back(path.string());
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+static void dropFromCache(std::vector<std::string> const& paths) {
+    #ifdef __linux__
+    for (auto const& path : paths) {
+        auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+    #endif
+}
+
+static void verify(
+    std::vector<Result<ModInfo>> const& infos,
+    std::vector<ModInfo const*> const& mods,
+    BenchLoader::LoadPlan const& plan
+) {
+    for (auto const& info : infos) {
+        if (!info) g_errors++;
+    }
+    // the generated mods only depend on each 
+    // other one way, so there are no cycles
+    if (plan.order.size() != mods.size() || plan.cycles.size()) {
+        g_errors++;
+    }
+    std::unordered_map<std::string, size_t> position;
+    for (size_t i = 0; i < plan.order.size(); i++) {
+        position[mods[plan.order[i]]->m_id] = i;
+    }
+    for (size_t i = 0; i < plan.order.size(); i++) {
+        for (auto const& dep : mods[plan.order[i]]->m_dependencies) {
+            auto found = position.find(dep.m_id);
+            if (found == position.end() || found->second > i) {
+                g_errors++;
+                break;
+            }
+        }
+    }
+}
+
+// best of a few runs, in milliseconds
+template <class Func>
+static double measure(std::vector<std::string> const& paths, bool cold, Func func) {
+    double best = 1e300;
+    for (int run = 0; run < 5; run++) {
+        if (cold) dropFromCache(paths);
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_mod_discovery_bench\",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"mods\": " << results[i].m_mods << ", "
+           << "\"threads\": " << results[i].m_threads << ", "
+           << "\"ms\": " << results[i].m_ms
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    size_t binarySize = 512 * 1024;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else if (arg == "--binary-kb" && i + 1 < argc) {
+            binarySize = std::stoul(argv[++i]) * 1024;
+        }
+    }
+
+    auto dir = std::filesystem::temp_directory_path() / "lilac_mod_discovery_bench";
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<bench_result> results;
+    for (size_t count : { 50, 100, 200 }) {
+        auto paths = generateMods(dir, count, binarySize);
+
+        for (auto cold : { true, false }) {
+            std::string suffix = cold ? "_cold" : "_warm";
+            std::vector<Result<ModInfo>> infos;
+            auto serial = measure(paths, cold, [&]() {
+                infos = Loader::readModInfos(paths, 1);
+            });
+            results.push_back({ "read" + suffix, count, 1, serial });
+
+            auto parallel = measure(paths, cold, [&]() {
+                infos = Loader::readModInfos(paths);
+            });
+            results.push_back({ "read" + suffix, count, threads, parallel });
+        }
+
+        auto infos = Loader::readModInfos(paths);
+        std::vector<ModInfo> read;
+        for (auto const& info : infos) {
+            if (info) read.push_back(info.value());
+        }
+        std::vector<ModInfo const*> mods;
+        for (auto const& info : read) {
+            mods.push_back(&info);
+        }
+        BenchLoader::LoadPlan plan;
+        auto planning = measure(paths, false, [&]() {
+            plan = BenchLoader::planLoadOrder(mods);
+        });
+        results.push_back({ "plan", count, 1, planning });
+        verify(infos, mods, plan);
+    }
+    std::filesystem::remove_all(dir);
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " mods were read or planned wrong\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Measures what toggling a group of byte patches costs, applying 
+// and restoring them one by one through Patch::apply/restore 
+// versus all at once through a PatchSet. Patches are placed in 
+// a read-only region of this binary, either spread out over 
+// many pages or packed next to each other. Results are printed 
+// as JSON; the exit code is nonzero if any patch didn't end up 
+// with the right bytes.
+//
+// usage: lilac_patch_bench [--out file.json]
+
+#include <Hook.hpp>
+#include <utils/casts.hpp>
+#include <core/hook/hook.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+// a patch without an owning mod, so the 
+// bench only needs the hook engine
+class BenchPatch : public Patch {
+    public:
+        BenchPatch(void* address, byte_array const& patch) {
+            m_owner = nullptr;
+            m_address = address;
+            m_patch = patch;
+            m_original = byte_array(patch.size());
+            lilac::core::hook::read_memory(address, m_original.data(), patch.size());
+        }
+};
+
+static constexpr const size_t s_patchSize = 2;
+static constexpr const size_t s_spreadStride = 16;
+static constexpr const size_t s_maxPatches = 10000;
+
+// const, so it ends up in read-only memory 
+// like the game's code would be
+alignas(4096) static const uint8_t g_region[s_maxPatches * s_spreadStride] = { 1 };
+
+struct bench_result {
+    std::string m_name;
+    std::string m_layout;
+    size_t m_patches;
+    size_t m_runs;
+    double m_usPerToggle;
+};
+
+// patches that didn't have the right bytes
+static size_t g_errors = 0;
+
+static void verify(std::vector<Patch*> const& patches, bool applied) {
+    for (auto const& patch : patches) {
+        auto bytes = as<volatile uint8_t*>(patch->getAddress());
+        auto offset = patch->getAddress() - as<uintptr_t>(g_region);
+        for (size_t i = 0; i < s_patchSize; i++) {
+            // compared with the region's initializer
+            uint8_t expected = applied ? 0xCC : (offset + i == 0 ? 1 : 0);
+            if (bytes[i] != expected) {
+                g_errors++;
+                break;
+            }
+        }
+    }
+}
+
+// best of a few runs, in microseconds per 
+// apply + restore of the whole group
+template <class Toggle>
+static double measure(size_t rounds, Toggle toggle) {
+    double best = 1e300;
+    for (int run = 0; run < 5; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; i++) {
+            toggle();
+        }
+        auto end = std::chrono::steady_clock::now();
+        auto us = std::chrono::duration<double, std::micro>(end - start).count();
+        best = std::min(best, us / rounds);
+    }
+    return best;
+}
+
+static void runLayout(
+    std::vector<bench_result>& results,
+    std::string const& layout,
+    size_t stride,
+    size_t count
+) {
+    std::vector<Patch*> patches;
+    PatchSet set;
+    for (size_t i = 0; i < count; i++) {
+        auto patch = new BenchPatch(
+            as<void*>(&g_region[i * stride]), byte_array(s_patchSize, 0xCC)
+        );
+        patches.push_back(patch);
+        auto add = set.add(patch);
+        if (!add) {
+            std::cerr << "Unable to add patch to set: " << add.error() << "\n";
+            std::exit(1);
+        }
+    }
+    // keep the total amount of work 
+    // roughly the same for every count
+    auto rounds = std::max<size_t>(1, 1000 / count);
+
+    auto perPatch = measure(rounds, [&]() {
+        for (auto const& patch : patches) {
+            patch->apply();
+        }
+        for (auto const& patch : patches) {
+            patch->restore();
+        }
+    });
+    results.push_back({ "per_patch", layout, count, count, perPatch });
+
+    for (auto const& patch : patches) {
+        patch->apply();
+    }
+    verify(patches, true);
+    for (auto const& patch : patches) {
+        patch->restore();
+    }
+    verify(patches, false);
+
+    auto batched = measure(rounds, [&]() {
+        set.apply();
+        set.restore();
+    });
+    results.push_back({ "batched", layout, count, set.getRunCount(), batched });
+
+    if (!set.apply()) {
+        g_errors++;
+    }
+    verify(patches, true);
+    if (!set.restore()) {
+        g_errors++;
+    }
+    verify(patches, false);
+
+    for (auto const& patch : patches) {
+        delete patch;
+    }
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_patch_bench\",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"layout\": \"" << results[i].m_layout << "\", "
+           << "\"patches\": " << results[i].m_patches << ", "
+           << "\"writes\": " << results[i].m_runs << ", "
+           << "\"us_per_toggle\": " << results[i].m_usPerToggle
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    std::vector<bench_result> results;
+    for (size_t count : { 10, 100, 1000, 10000 }) {
+        // a patch every few instructions, 
+        // across many pages
+        runLayout(results, "spread", s_spreadStride, count);
+        // one contiguous block, i.e. a 
+        // function being nopped out
+        runLayout(results, "adjacent", s_patchSize, count);
+    }
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " patches had the wrong bytes\n";
+        return 1;
+    }
+    return 0;
+}
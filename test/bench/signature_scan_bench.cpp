@@ -0,0 +1,200 @@
+// Measures signature scanning throughput in GB/s over a synthetic 
+// buffer the size of a game binary's code, with 1 versus 16 
+// signatures scanned in one pass, on one thread versus every 
+// core, next to a naive scan of 1 signature that compares one 
+// position at a time. Every signature is taken from the end of 
+// the buffer so the whole buffer is scanned, and has wildcards 
+// where a real signature would have addresses. Whether the AVX2 
+// path was used is part of the output. Results are printed as 
+// JSON; the exit code is nonzero if a signature wasn't found 
+// where it was taken from.
+//
+// usage: lilac_signature_scan_bench [--mb N] [--out file.json]
+
+#include <Signature.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+USE_LILAC_NAMESPACE();
+
+struct bench_result {
+    std::string m_name;
+    size_t m_signatures;
+    unsigned m_threads;
+    double m_ms;
+    double m_gbPerSecond;
+};
+
+// signatures found in the wrong place
+static size_t g_errors = 0;
+
+static constexpr const size_t s_signatureSize = 24;
+
+// x86 code has some bytes a lot more often than 
+// others, which matters for how often a 
+// signature's anchors match by chance; the 
+// buffer is weighted towards the usual ones
+static byte_array generateBuffer(size_t size) {
+    static constexpr const uint8_t s_common[] = {
+        0x00, 0x8B, 0x89, 0xFF, 0x48, 0x24, 0xE8, 0x45,
+        0x0F, 0x83, 0x85, 0x44, 0x4C, 0xC3, 0xCC, 0x55,
+    };
+    std::mt19937 rng(42);
+    byte_array data(size);
+    for (auto& byte : data) {
+        auto value = rng();
+        byte = value % 2 ? s_common[(value >> 1) % 16] : static_cast<uint8_t>(value >> 8);
+    }
+    return data;
+}
+
+// signatures taken from the last few kilobytes 
+// of the buffer, with the 4 bytes of a call or 
+// jump target wildcarded
+static std::vector<Signature> takeSignatures(
+    byte_array const& data, size_t count, std::vector<ptrdiff_t>& expected
+) {
+    std::vector<Signature> sigs;
+    for (size_t i = 0; i < count; i++) {
+        auto pos = data.size() - (i + 1) * 256;
+        std::string pattern;
+        for (size_t j = 0; j < s_signatureSize; j++) {
+            if (j >= 8 && j < 12) {
+                pattern += "?? ";
+                continue;
+            }
+            char byte[4];
+            snprintf(byte, sizeof(byte), "%02X ", data[pos + j]);
+            pattern += byte;
+        }
+        auto sig = Signature::parse(pattern);
+        if (!sig) {
+            std::cerr << sig.error() << "\n";
+            std::exit(1);
+        }
+        sigs.push_back(sig.value());
+        expected.push_back(pos);
+    }
+    return sigs;
+}
+
+static std::vector<ptrdiff_t> naiveScan(
+    byte_array const& data, std::vector<Signature> const& sigs
+) {
+    std::vector<ptrdiff_t> res(sigs.size(), -1);
+    for (size_t i = 0; i < sigs.size(); i++) {
+        for (size_t pos = 0; pos + sigs[i].size() <= data.size(); pos++) {
+            if (sigs[i].matches(data.data() + pos)) {
+                res[i] = pos;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+static void verify(std::vector<ptrdiff_t> const& found, std::vector<ptrdiff_t> const& expected) {
+    if (found != expected) {
+        g_errors++;
+    }
+}
+
+// best of a few runs, in milliseconds
+template <class Func>
+static double measure(int runs, Func func) {
+    double best = 1e300;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static std::string toJSON(std::vector<bench_result> const& results, size_t size) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_signature_scan_bench\",\n";
+    ss << "    \"avx2\": " << (SignatureScanner::hasAVX2() ? "true" : "false") << ",\n";
+    ss << "    \"buffer_mb\": " << size / (1024 * 1024) << ",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"signatures\": " << results[i].m_signatures << ", "
+           << "\"threads\": " << results[i].m_threads << ", "
+           << "\"ms\": " << results[i].m_ms << ", "
+           << "\"gb_per_s\": " << results[i].m_gbPerSecond
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    size_t size = 64 * 1024 * 1024;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else if (arg == "--mb" && i + 1 < argc) {
+            size = std::max<size_t>(1, std::stoul(argv[++i])) * 1024 * 1024;
+        }
+    }
+
+    auto data = generateBuffer(size);
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<bench_result> results;
+    auto add = [&](std::string const& name, size_t sigs, unsigned threads, double ms) {
+        results.push_back({ name, sigs, threads, ms, size / (ms * 1e6) });
+    };
+
+    for (size_t count : { 1, 16 }) {
+        std::vector<ptrdiff_t> expected;
+        auto sigs = takeSignatures(data, count, expected);
+
+        // the naive scan takes long enough 
+        // that a single run is plenty
+        std::vector<ptrdiff_t> found;
+        if (count == 1) {
+            add("naive", count, 1, measure(1, [&]() {
+                found = naiveScan(data, sigs);
+            }));
+            verify(found, expected);
+        }
+
+        std::vector<unsigned> scanThreads { 1 };
+        if (threads > 1) {
+            scanThreads.push_back(threads);
+        }
+        for (auto const& scanThreadCount : scanThreads) {
+            add("scan", count, scanThreadCount, measure(5, [&]() {
+                found = SignatureScanner::scan(data.data(), data.size(), sigs, scanThreadCount);
+            }));
+            verify(found, expected);
+        }
+    }
+
+    auto json = toJSON(results, size);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " scans found signatures in the wrong place\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+// Checks the signature scanner on synthetic buffers: parsing, 
+// matches at the very start & end of a buffer, wildcards as the 
+// first & last byte, signatures longer than the buffer, many 
+// signatures in one pass, matches straddling the chunks the 
+// buffer is split into for threads, the first of several 
+// matches winning, and the signature's offset being added. On 
+// top of that, random buffers & signatures are scanned with 1 
+// and 4 threads and compared with a naive byte-by-byte scan. 
+// Finally a signature taken from a function in a loaded 
+// module is found through the module scan.
+//
+// usage: lilac_signature_scan_test
+
+#include <Signature.hpp>
+#include "bench_symbols.hpp"
+#include <iostream>
+#include <random>
+
+static size_t g_errors = 0;
+
+static void check(bool ok, std::string const& what) {
+    if (!ok) {
+        std::cerr << what << "\n";
+        g_errors++;
+    }
+}
+
+static Signature sig(std::string const& pattern, ptrdiff_t offset = 0) {
+    auto res = Signature::parse(pattern, offset);
+    if (!res) {
+        std::cerr << res.error() << "\n";
+        std::exit(1);
+    }
+    return res.value();
+}
+
+// the first match of every signature, one 
+// position at a time
+static std::vector<ptrdiff_t> naiveScan(
+    byte_array const& data, std::vector<Signature> const& sigs
+) {
+    std::vector<ptrdiff_t> res;
+    for (auto const& s : sigs) {
+        ptrdiff_t found = -1;
+        for (size_t pos = 0; pos + s.size() <= data.size(); pos++) {
+            bool match = true;
+            for (size_t i = 0; i < s.size() && match; i++) {
+                match = (data[pos + i] & s.getMask()[i]) == s.getBytes()[i];
+            }
+            if (match) {
+                found = pos + s.getOffset();
+                break;
+            }
+        }
+        res.push_back(found);
+    }
+    return res;
+}
+
+static void expectScan(
+    std::string const& name,
+    byte_array const& data,
+    std::vector<Signature> const& sigs,
+    std::vector<ptrdiff_t> const& expected,
+    unsigned threads = 1
+) {
+    auto found = SignatureScanner::scan(data.data(), data.size(), sigs, threads);
+    check(found.size() == expected.size(), name + ": wrong amount of results");
+    for (size_t i = 0; i < found.size() && i < expected.size(); i++) {
+        check(
+            found[i] == expected[i],
+            name + ": signature " + std::to_string(i) + " found at " + 
+            std::to_string(found[i]) + ", expected " + std::to_string(expected[i])
+        );
+    }
+}
+
+static void testParse() {
+    auto res = Signature::parse("55 8B EC ? 6A ?? 68");
+    check(!!res, "a valid pattern didn't parse");
+    if (res) {
+        auto s = res.value();
+        check(s.size() == 7, "a parsed pattern has the wrong size");
+        check(
+            s.getMask() == byte_array { 0xFF, 0xFF, 0xFF, 0, 0xFF, 0, 0xFF },
+            "a parsed pattern has the wrong mask"
+        );
+        check(
+            s.getBytes() == byte_array { 0x55, 0x8B, 0xEC, 0, 0x6A, 0, 0x68 },
+            "a parsed pattern has the wrong bytes"
+        );
+    }
+    check(!Signature::parse("55 8G"), "an invalid byte parsed");
+    check(!Signature::parse("55 8"), "a half byte parsed");
+    check(!Signature::parse("?? ? ??"), "a pattern without concrete bytes parsed");
+    check(!Signature::parse(""), "an empty pattern parsed");
+    check(
+        sig("55 8B").getHash() != sig("55 8B", 1).getHash() &&
+        sig("55 8B").getHash() != sig("55 ??").getHash(),
+        "different signatures hash the same"
+    );
+}
+
+static void testEdges() {
+    // big enough for every vector path
+    byte_array data(256, 0);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+
+    expectScan("start", data, { sig("00 01 02 03") }, { 0 });
+    expectScan("end", data, { sig("FC FD FE FF") }, { 252 });
+    expectScan("single byte at the end", data, { sig("FF") }, { 255 });
+    expectScan("wildcard first", data, { sig("?? 01 02") }, { 0 });
+    expectScan("wildcard last", data, { sig("FD FE ??") }, { 253 });
+    expectScan("wildcards at both ends", data, { sig("?? 41 42 ??") }, { 0x40 });
+    expectScan("wildcard past the end", data, { sig("FE FF ??") }, { -1 });
+    expectScan("wildcard before the start", data, { sig("?? 00 01") }, { -1 });
+    expectScan("offset", data, { sig("10 11", 5), sig("20 21", -3) }, { 0x15, 0x1D });
+    expectScan("not found", data, { sig("01 00") }, { -1 });
+
+    byte_array small { 1, 2, 3 };
+    expectScan("longer than the buffer", small, { sig("01 02 03 04") }, { -1 });
+    expectScan("as long as the buffer", small, { sig("01 ?? 03") }, { 0 });
+    expectScan("empty buffer", {}, { sig("01") }, { -1 });
+
+    // the same match found by every vector 
+    // path, from every alignment
+    for (size_t pos = 0; pos + 40 <= data.size(); pos++) {
+        byte_array zeros(data.size(), 0);
+        for (size_t i = 0; i < 40; i++) {
+            zeros[pos + i] = static_cast<uint8_t>(0x80 + i);
+        }
+        std::string pattern = "?? ";
+        for (size_t i = 1; i < 39; i++) {
+            char byte[4];
+            snprintf(byte, sizeof(byte), "%02X ", 0x80 + static_cast<unsigned>(i));
+            pattern += byte;
+        }
+        pattern += "??";
+        expectScan("alignment " + std::to_string(pos), zeros, { sig(pattern) }, { 
+            static_cast<ptrdiff_t>(pos)
+        });
+    }
+}
+
+static void testMany() {
+    std::mt19937 rng(5);
+    byte_array data(64 * 1024);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    // 16 signatures taken from the buffer, 
+    // and some that aren't in it
+    std::vector<Signature> sigs;
+    std::vector<ptrdiff_t> expected;
+    for (size_t i = 0; i < 16; i++) {
+        size_t pos = i * 4001 + 3;
+        std::string pattern;
+        for (size_t j = 0; j < 12; j++) {
+            char byte[4];
+            snprintf(byte, sizeof(byte), "%02X ", data[pos + j]);
+            pattern += j % 5 == 2 ? std::string("?? ") : byte;
+        }
+        sigs.push_back(sig(pattern));
+        expected.push_back(pos);
+    }
+    sigs.push_back(sig("DE AD BE EF DE AD BE EF DE AD BE EF"));
+    expected.push_back(-1);
+    sigs.push_back(sig("00 ?? 00 ?? 00 ?? 00 ?? 00 ?? 00 ?? 00"));
+    expected.push_back(-1);
+
+    expectScan("many signatures", data, sigs, expected);
+    check(expected == naiveScan(data, sigs), "the planted signatures aren't unique");
+}
+
+static void testThreads() {
+    // every thread gets at least a megabyte, so 
+    // this is split into 4 chunks of 1 MB
+    static constexpr const size_t s_chunk = 1024 * 1024;
+    byte_array data(4 * s_chunk, 0);
+
+    // straddles the first chunk border
+    byte_array straddle { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    std::copy(straddle.begin(), straddle.end(), data.begin() + s_chunk - 3);
+    // in the last chunk, and earlier in the 
+    // third: the earlier one wins even though 
+    // the threads find both
+    byte_array twice { 0x77, 0x88, 0x99, 0xAA };
+    std::copy(twice.begin(), twice.end(), data.end() - 4);
+    std::copy(twice.begin(), twice.end(), data.begin() + 2 * s_chunk + 100);
+    // in the first chunk and again early in 
+    // the second
+    byte_array early { 0xBB, 0xCC, 0xDD };
+    std::copy(early.begin(), early.end(), data.begin() + 7);
+    std::copy(early.begin(), early.end(), data.begin() + s_chunk + 16);
+
+    std::vector<Signature> sigs {
+        sig("11 22 33 44 55 66"),
+        sig("77 88 ?? AA"),
+        sig("BB ?? DD"),
+        sig("?? ?? ?? 11 ?? ?? ?? 55 66"),
+    };
+    std::vector<ptrdiff_t> expected {
+        static_cast<ptrdiff_t>(s_chunk - 3),
+        static_cast<ptrdiff_t>(2 * s_chunk + 100),
+        7,
+        static_cast<ptrdiff_t>(s_chunk - 6),
+    };
+    expectScan("one thread", data, sigs, expected, 1);
+    expectScan("four threads", data, sigs, expected, 4);
+    expectScan("automatic threads", data, sigs, expected, 0);
+}
+
+static void testRandom() {
+    // few different bytes, so partial & 
+    // overlapping matches are everywhere
+    std::mt19937 rng(1234);
+    for (size_t run = 0; run < 2000; run++) {
+        size_t size = run % 10 == 0 ? rng() % 70000 : rng() % 300;
+        unsigned alphabet = 2 + rng() % 3;
+        byte_array data(size);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng() % alphabet);
+        }
+
+        std::vector<Signature> sigs;
+        size_t count = 1 + rng() % 4;
+        for (size_t i = 0; i < count; i++) {
+            std::string pattern;
+            size_t len = 1 + rng() % 40;
+            for (size_t j = 0; j < len; j++) {
+                if (rng() % 4 == 0) {
+                    pattern += "?? ";
+                } else {
+                    pattern += "0" + std::to_string(rng() % alphabet) + " ";
+                }
+            }
+            // needs at least one concrete byte
+            pattern += "00";
+            sigs.push_back(sig(pattern, rng() % 3));
+        }
+
+        auto expected = naiveScan(data, sigs);
+        expectScan("random " + std::to_string(run), data, sigs, expected);
+    }
+
+    // and some big enough for threads
+    for (size_t run = 0; run < 4; run++) {
+        byte_array data(4 * 1024 * 1024 + rng() % 4096);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng() % 4);
+        }
+        std::vector<Signature> sigs;
+        for (size_t len : { 10, 12, 14 }) {
+            std::string pattern;
+            for (size_t j = 0; j < len; j++) {
+                pattern += "0" + std::to_string(rng() % 4) + " ";
+            }
+            pattern += "??";
+            sigs.push_back(sig(pattern));
+        }
+        auto expected = naiveScan(data, sigs);
+        expectScan("random threaded " + std::to_string(run), data, sigs, expected, 4);
+    }
+}
+
+static void testModule() {
+    auto symbol = getBenchSymbols().front();
+    auto addr = as<const uint8_t*>(findBenchSymbol(symbol));
+    if (!addr) {
+        check(false, std::string("unable to find ") + symbol);
+        return;
+    }
+    check(
+        SignatureScanner::getExecutableRanges(s_benchModule).size() > 0,
+        "the module has no executable ranges"
+    );
+
+    std::string pattern;
+    for (size_t i = 0; i < 24; i++) {
+        char byte[4];
+        snprintf(byte, sizeof(byte), "%02X ", addr[i]);
+        pattern += byte;
+    }
+    auto s = sig(pattern);
+    auto res = SignatureScanner::scan(s_benchModule, s);
+    if (!res) {
+        check(false, res.error());
+    } else {
+        // identical code may come earlier, so 
+        // only check that the match is real
+        check(
+            res.value() <= as<uintptr_t>(addr) && s.matches(as<const uint8_t*>(res.value())),
+            "the module scan found the wrong match"
+        );
+    }
+    check(
+        !SignatureScanner::scan("lilac_module_that_does_not_exist.so", s),
+        "an unknown module was scanned"
+    );
+}
+
+int main() {
+    // the module scan caches under the working 
+    // directory
+    auto dir = enterBenchDirectory("lilac_signature_scan_test");
+
+    testParse();
+    testEdges();
+    testMany();
+    testThreads();
+    testRandom();
+    testModule();
+
+    leaveBenchDirectory(dir);
+
+    if (g_errors) {
+        std::cerr << g_errors << " signature scan errors\n";
+        return 1;
+    }
+    std::cout << "all signatures found where they should be (avx2: " << 
+        (SignatureScanner::hasAVX2() ? "yes" : "no") << ")\n";
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Measures how long it takes to resolve a module's worth of 
+// symbols on a cold start, with no cache on disk so every 
+// symbol is looked up in the module's exports, versus a warm 
+// start that loads the cache written by the cold one, versus 
+// resolving them again once they're all cached in memory. 
+// Every run uses a fresh resolver, and the cache is written 
+// to a temporary working directory. Results are printed as 
+// JSON; the exit code is nonzero if a symbol resolved to 
+// anything but what the platform's own lookup gives.
+//
+// usage: lilac_symbol_resolver_bench [--out file.json]
+
+#include "bench_symbols.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+struct bench_result {
+    std::string m_name;
+    size_t m_symbols;
+    double m_us;
+    double m_nsPerSymbol;
+};
+
+// symbols that resolved wrong
+static size_t g_errors = 0;
+
+// what every symbol should resolve to, looked 
+// up up front so the platform's lookup isn't 
+// measured along with the resolver
+static std::vector<uintptr_t> g_expected;
+
+static void resolveAll(BenchResolver& resolver) {
+    auto const& symbols = getBenchSymbols();
+    for (size_t i = 0; i < symbols.size(); i++) {
+        auto res = resolver.resolve(s_benchModule, symbols[i]);
+        if (!res || res.value() != g_expected[i]) {
+            g_errors++;
+        }
+    }
+}
+
+// best of a few runs, in microseconds. `prepare` 
+// runs before every run and isn't measured
+template <class Prepare, class Func>
+static double measure(Prepare prepare, Func func) {
+    double best = 1e300;
+    for (int run = 0; run < 20; run++) {
+        BenchResolver resolver;
+        prepare(resolver);
+        auto start = std::chrono::steady_clock::now();
+        func(resolver);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    return best;
+}
+
+static std::string toJSON(std::vector<bench_result> const& results) {
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "    \"benchmark\": \"lilac_symbol_resolver_bench\",\n";
+    ss << "    \"module\": \"" << s_benchModule << "\",\n";
+    ss << "    \"errors\": " << g_errors << ",\n";
+    ss << "    \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        ss << "        { "
+           << "\"name\": \"" << results[i].m_name << "\", "
+           << "\"symbols\": " << results[i].m_symbols << ", "
+           << "\"us\": " << results[i].m_us << ", "
+           << "\"ns_per_symbol\": " << results[i].m_nsPerSymbol
+           << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "    ]\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        }
+    }
+
+    auto dir = enterBenchDirectory("lilac_symbol_resolver_bench");
+    auto count = getBenchSymbols().size();
+    for (auto const& symbol : getBenchSymbols()) {
+        g_expected.push_back(findBenchSymbol(symbol));
+    }
+    std::vector<bench_result> results;
+    auto add = [&](std::string const& name, double us) {
+        results.push_back({ name, count, us, us * 1000.0 / count });
+    };
+
+    add("cold", measure(
+        [](BenchResolver&) {
+            std::filesystem::remove(SymbolResolver::getCachePath());
+        },
+        resolveAll
+    ));
+
+    {
+        BenchResolver resolver;
+        resolveAll(resolver);
+        auto res = resolver.saveCache();
+        if (!res) {
+            std::cerr << res.error() << "\n";
+            g_errors++;
+        }
+    }
+    add("warm", measure([](BenchResolver&) {}, resolveAll));
+
+    add("cached", measure(resolveAll, resolveAll));
+
+    leaveBenchDirectory(dir);
+
+    auto json = toJSON(results);
+    if (out.size()) {
+        std::ofstream file(out);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+    if (g_errors) {
+        std::cerr << g_errors << " symbols resolved wrong\n";
+        return 1;
+    }
+    return 0;
+}
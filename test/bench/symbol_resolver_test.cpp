@@ -0,0 +1,177 @@
+// Checks the symbol resolver against the platform's own lookup: 
+// every symbol of a module every process has loaded resolves to 
+// the address GetProcAddress / dlsym gives, unknown symbols & 
+// modules are errors, resolved symbols survive a round-trip 
+// through the cache on disk, and cache files that are corrupt or 
+// were written for a different build of the module are ignored. 
+// Runs in a temporary working directory so it never touches a 
+// real cache.
+//
+// usage: lilac_symbol_resolver_test
+
+#include "bench_symbols.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static size_t g_errors = 0;
+
+static void check(bool ok, std::string const& what) {
+    if (!ok) {
+        std::cerr << what << "\n";
+        g_errors++;
+    }
+}
+
+static void testResolve() {
+    BenchResolver resolver;
+    for (auto const& symbol : getBenchSymbols()) {
+        auto res = resolver.resolve(s_benchModule, symbol);
+        if (!res) {
+            check(false, res.error());
+            continue;
+        }
+        check(
+            res.value() == findBenchSymbol(symbol),
+            std::string(symbol) + " resolved to the wrong address"
+        );
+        // the second time comes from the cache
+        auto again = resolver.resolve(s_benchModule, symbol);
+        check(
+            again && again.value() == res.value(),
+            std::string(symbol) + " resolved differently the second time"
+        );
+    }
+    check(
+        resolver.getCachedCount() == getBenchSymbols().size(),
+        "not every resolved symbol was cached"
+    );
+}
+
+static void testUnknown() {
+    BenchResolver resolver;
+    check(
+        !resolver.resolve(s_benchModule, "lilac_symbol_that_does_not_exist"),
+        "an unknown symbol resolved"
+    );
+    check(
+        !resolver.resolve("lilac_module_that_does_not_exist.so", "strlen"),
+        "a symbol in an unknown module resolved"
+    );
+    check(
+        !resolver.getModuleBase("lilac_module_that_does_not_exist.so"),
+        "an unknown module has a base"
+    );
+    check(
+        resolver.lookup("lilac_module_that_does_not_exist.so", 1) == 0,
+        "an unknown module has cached addresses"
+    );
+}
+
+static void testCacheRoundTrip() {
+    {
+        BenchResolver resolver;
+        for (auto const& symbol : getBenchSymbols()) {
+            resolver.resolve(s_benchModule, symbol);
+        }
+        // arbitrary keys are cached just the same
+        auto base = resolver.getModuleBase(s_benchModule);
+        check(!!base, "the module has no base");
+        if (base) {
+            resolver.remember(s_benchModule, 0x1234, base.value() + 0x10);
+        }
+        auto res = resolver.saveCache();
+        if (!res) {
+            check(false, res.error());
+        }
+    }
+    check(
+        std::filesystem::exists(SymbolResolver::getCachePath()),
+        "the cache wasn't written"
+    );
+
+    BenchResolver resolver;
+    for (auto const& symbol : getBenchSymbols()) {
+        check(
+            resolver.lookup(s_benchModule, symbol_name(symbol).m_hash) == 
+                findBenchSymbol(symbol),
+            std::string(symbol) + " didn't come back from the cache"
+        );
+    }
+    auto base = resolver.getModuleBase(s_benchModule);
+    check(
+        base && resolver.lookup(s_benchModule, 0x1234) == base.value() + 0x10,
+        "a remembered address didn't come back from the cache"
+    );
+    check(
+        resolver.lookup(s_benchModule, 0x4321) == 0,
+        "a key that was never remembered came back from the cache"
+    );
+    // nothing new was resolved, so there's 
+    // nothing to save
+    check(!!resolver.saveCache(), "saving an unchanged cache failed");
+}
+
+static void writeCache(std::string const& data) {
+    std::ofstream file(SymbolResolver::getCachePath(), std::ios::binary);
+    file.write(data.data(), data.size());
+}
+
+static void testCorruptCache() {
+    auto symbol = getBenchSymbols().front();
+
+    // garbage, a header without its entries, 
+    // and an entry for another build
+    std::vector<std::string> caches { "not a cache at all" };
+
+    uint32_t header[3] = { 0x4d59534c, 1, 1 };
+    caches.push_back(std::string(as<char*>(header), sizeof(header)));
+
+    BenchResolver reference;
+    auto info = reference.getModuleInfo(s_benchModule);
+    check(!!info, "the module wasn't found");
+    if (info) {
+        uint64_t entry[3] = {
+            info.value()->m_nameHash,
+            info.value()->m_checksum + 1,
+            symbol_name(symbol).m_hash,
+        };
+        uint32_t rva = 0x10;
+        auto stale = std::string(as<char*>(header), sizeof(header));
+        stale += std::string(as<char*>(entry), sizeof(entry));
+        stale += std::string(as<char*>(&rva), sizeof(rva));
+        caches.push_back(stale);
+    }
+
+    for (auto const& cache : caches) {
+        writeCache(cache);
+        BenchResolver resolver;
+        check(
+            resolver.lookup(s_benchModule, symbol_name(symbol).m_hash) == 0,
+            "an address came from a corrupt or stale cache"
+        );
+        auto res = resolver.resolve(s_benchModule, symbol);
+        check(
+            res && res.value() == findBenchSymbol(symbol),
+            "a symbol didn't resolve past a corrupt or stale cache"
+        );
+    }
+}
+
+int main() {
+    auto dir = enterBenchDirectory("lilac_symbol_resolver_test");
+
+    testResolve();
+    testUnknown();
+    testCacheRoundTrip();
+    testCorruptCache();
+
+    leaveBenchDirectory(dir);
+
+    if (g_errors) {
+        std::cerr << g_errors << " symbol resolver errors\n";
+        return 1;
+    }
+    std::cout << "resolved " << getBenchSymbols().size() << " symbols\n";
+    return 0;
+}
@@ -1,7 +1,7 @@
 #include "mod2.hpp"
 
-bool __fastcall GJGarageLayer_init(GJGarageLayer* self) {
-    if (!self->init())
+bool __fastcall GJGarageLayer_init(GJGarageLayer* self, edx_t) {
+    if (!original<&GJGarageLayer::init>(self))
         return false;
     
     if (Loader::get()->isModLoaded("com.lilac.test_one")) {
@@ -14,7 +14,7 @@ bool __fastcall GJGarageLayer_init(GJGarageLayer* self) {
 }
 
 void TestMod2::setup() {
-    this->addHook(
+    this->addHook<&GJGarageLayer::init>(
         gd_base + 0x1255d0,
         &GJGarageLayer_init
     );
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+Generates AddressTable.gen.hpp from a bindings file: one constexpr 
+perfect-hash table of (Class::method -> offset) per game build.
+
+usage: address_table.py <bindings> <output header>
+
+The hashing has to match AddressTable.hpp exactly.
+"""
+
+import re
+import sys
+
+MASK = (1 << 64) - 1
+
+
+def fnv1a(data):
+    res = 0xcbf29ce484222325
+    for b in data:
+        res ^= b
+        res = (res * 0x100000001b3) & MASK
+    return res
+
+
+def mix(x):
+    x ^= x >> 33
+    x = (x * 0xff51afd7ed558ccd) & MASK
+    x ^= x >> 33
+    x = (x * 0xc4ceb9fe1a85ec53) & MASK
+    x ^= x >> 33
+    return x
+
+
+def bucket_of(key, count):
+    return (key >> 32) % count
+
+
+def slot_of(key, seed, size):
+    return mix(key ^ ((seed * 0x9e3779b97f4a7c15) & MASK)) % size
+
+
+def build_hash(timestamp, checksum, size):
+    data = b"".join(v.to_bytes(4, "little") for v in (timestamp, checksum, size))
+    return fnv1a(data)
+
+
+def parse(path):
+    builds = []
+    with open(path) as f:
+        for num, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            where = f"{path}:{num}"
+            if line.startswith("build "):
+                m = re.fullmatch(r'build\s+"([^"]+)"\s*(.*)', line)
+                if not m:
+                    sys.exit(f"{where}: malformed build line")
+                name, rest = m.groups()
+                if rest == "default":
+                    ident = 0
+                else:
+                    fields = dict(re.findall(r"(\w+)=(0x[0-9a-fA-F]+|\d+)", rest))
+                    try:
+                        ident = build_hash(*(
+                            int(fields[k], 0) for k in ("timestamp", "checksum", "size")
+                        ))
+                    except KeyError as e:
+                        sys.exit(f"{where}: build lacks {e.args[0]}")
+                builds.append({"name": name, "build": ident, "entries": {}})
+                continue
+            if not builds:
+                sys.exit(f"{where}: binding outside of a build")
+            m = re.fullmatch(r"([\w:]+::\w+)\s+(0x[0-9a-fA-F]+|\d+)", line)
+            if not m:
+                sys.exit(f"{where}: malformed binding")
+            name, offset = m.groups()
+            entries = builds[-1]["entries"]
+            if name in entries:
+                sys.exit(f"{where}: {name} bound twice")
+            entries[name] = int(offset, 0)
+    if sum(1 for b in builds if b["build"] == 0) > 1:
+        sys.exit(f"{path}: more than one default build")
+    return builds
+
+
+def perfect_hash(entries):
+    """
+    Hash and displace: keys are split into buckets, and every 
+    bucket gets the first seed that puts all of its keys into 
+    free slots, biggest buckets first.
+    """
+    keys = {fnv1a(name.encode()): offset for name, offset in entries.items()}
+    if len(keys) != len(entries):
+        sys.exit("hash collision between two bindings")
+    size = max(1, len(keys))
+    bucket_count = max(1, (len(keys) + 3) // 4)
+
+    buckets = [[] for _ in range(bucket_count)]
+    for key in keys:
+        buckets[bucket_of(key, bucket_count)].append(key)
+
+    seeds = [0] * bucket_count
+    slots = [None] * size
+    for ix in sorted(range(bucket_count), key=lambda i: -len(buckets[i])):
+        bucket = buckets[ix]
+        if not bucket:
+            continue
+        seed = 0
+        while True:
+            taken = [slot_of(key, seed, size) for key in bucket]
+            if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+                break
+            seed += 1
+        seeds[ix] = seed
+        for key, slot in zip(bucket, taken):
+            slots[slot] = (key, keys[key])
+    return [s or (0, 0) for s in slots], seeds
+
+
+def generate(builds, source):
+    out = [
+        f"// Generated by tools/address_table.py from {source}; do not edit",
+        "#pragma once",
+        "",
+        '#include "AddressTable.hpp"',
+        "",
+    ]
+    tables = []
+    for i, build in enumerate(builds):
+        slots, seeds = perfect_hash(build["entries"])
+        names = {fnv1a(n.encode()): n for n in build["entries"]}
+        out.append(f"// {build['name']}")
+        out.append(f"static constexpr address_entry g_addressEntries{i}[] = {{")
+        for key, offset in slots:
+            comment = f" // {names[key]}" if key else ""
+            out.append(f"    {{ 0x{key:016x}ull, 0x{offset:x} }},{comment}")
+        out.append("};")
+        out.append(f"static constexpr uint32_t g_addressSeeds{i}[] = {{")
+        out.append("    " + ", ".join(str(s) for s in seeds))
+        out.append("};")
+        out.append("")
+        tables.append(
+            f'    {{ "{build["name"]}", 0x{build["build"]:016x}ull, '
+            f"g_addressEntries{i}, {len(slots)}, "
+            f"g_addressSeeds{i}, {len(seeds)} }},"
+        )
+    out.append("static constexpr address_table g_addressTables[] = {")
+    out.extend(tables or ['    { "none", 0, nullptr, 0, nullptr, 0 },'])
+    out.append("};")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip())
+    source, output = sys.argv[1], sys.argv[2]
+    header = generate(parse(source), source.replace("\\", "/").split("/")[-1])
+    try:
+        with open(output) as f:
+            if f.read() == header:
+                return
+    except OSError:
+        pass
+    with open(output, "w") as f:
+        f.write(header)
+
+
+if __name__ == "__main__":
+    main()